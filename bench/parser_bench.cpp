@@ -0,0 +1,266 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   parser_bench.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 13:24:52 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 13:24:52 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Microbenchmark del parser de peticiones: mete la misma petición una y
+// otra vez por un RecvBuffer, como hace ClientConnection, y mide MB/s.
+// Con cabeceras de navegador de 500 a 1500 bytes repite las medidas con
+// cada kernel de HttpScan que soporte la CPU, después de comprobar que
+// todos dan el mismo resultado que el escalar.
+// Uso: make bench   (o ./bench/parser_bench [segundos por caso])
+
+#include "Request.hpp"
+#include "RecvBuffer.hpp"
+#include "HttpScan.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <ctime>
+
+static double nowSeconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Parsea 'message' entregándolo en trozos de 'slice' bytes (0 = de golpe)
+static bool parseOnce(Request& request, RecvBuffer& buffer, const std::string& message,
+					  size_t slice) {
+	size_t offset = 0;
+	if (slice == 0)
+		slice = message.size();
+	request.reset();
+	while (offset < message.size()) {
+		size_t len = std::min(slice, message.size() - offset);
+		buffer.prepare(len);
+		std::memcpy(buffer.writePtr(), message.data() + offset, len);
+		buffer.commit(len);
+		offset += len;
+		// La cabecera y el body se entregan en llamadas separadas
+		size_t used;
+		do {
+			used = request.parse(buffer.data(), buffer.size());
+			buffer.consume(used);
+		} while (used > 0 && request.getState() == BODY);
+		if (request.getState() == ERROR)
+			return false;
+	}
+	return request.isComplete();
+}
+
+// Por defecto el body se queda en memoria para medir sólo el parser;
+// bodyMemory pequeño mide también el volcado a un temporal en /tmp
+static void runCase(const char* name, const std::string& message, size_t slice, double seconds,
+					size_t bodyMemory = 1024 * 1024) {
+	Request request;
+	request.setBodyBuffering(bodyMemory, "/tmp");
+	BufferPool pool;
+	RecvBuffer buffer;
+	buffer.setPool(&pool);
+
+	if (!parseOnce(request, buffer, message, slice)) {
+		std::printf("%-28s  parse failed\n", name);
+		return;
+	}
+
+	size_t iterations = 0;
+	double start = nowSeconds();
+	double elapsed = 0;
+	while (elapsed < seconds) {
+		for (int i = 0; i < 1000; ++i)
+			parseOnce(request, buffer, message, slice);
+		iterations += 1000;
+		elapsed = nowSeconds() - start;
+	}
+
+	double mb = static_cast<double>(message.size()) * iterations / (1024.0 * 1024.0);
+	std::printf("%-28s %7lu B  %9.1f MB/s  %10.0f req/s\n", name,
+				static_cast<unsigned long>(message.size()), mb / elapsed, iterations / elapsed);
+}
+
+// Cada kernel contra el escalar en todas las posiciones y longitudes de
+// unos buffers aleatorios con pocos delimitadores, para pasar por el
+// camino vectorial y por la cola escalar
+static bool kernelsAgree() {
+	const char alphabet[] = "abcXYZ019-_.!~:;/ \t\r\n\x01\x7f\x80\xff\"(";
+	char buffer[256];
+	unsigned int seed = 42;
+	for (int round = 0; round < 200; ++round) {
+		for (size_t i = 0; i < sizeof(buffer); ++i) {
+			seed = seed * 1103515245 + 12345;
+			// Sobre todo letras, para que haya tramos largos sin delimitadores
+			size_t pick = (seed >> 16) % 64;
+			buffer[i] = pick < sizeof(alphabet) - 1 ? alphabet[pick] : 'a' + pick % 26;
+		}
+		for (size_t start = 0; start < 40; ++start) {
+			for (size_t end = start; end <= sizeof(buffer); ++end) {
+				HttpScan::useKernel(HttpScan::SCALAR);
+				const char* control = HttpScan::findControl(buffer + start, buffer + end);
+				const char* token = HttpScan::findNonToken(buffer + start, buffer + end);
+				for (int k = HttpScan::SSE2; k <= HttpScan::AVX2; ++k) {
+					if (!HttpScan::useKernel(static_cast<HttpScan::Kernel>(k)))
+						continue;
+					if (HttpScan::findControl(buffer + start, buffer + end) != control
+						|| HttpScan::findNonToken(buffer + start, buffer + end) != token) {
+						std::printf("kernel %s differs from scalar\n",
+									HttpScan::kernelName(static_cast<HttpScan::Kernel>(k)));
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// Consultas que hace el servidor por petición (Host, Connection,
+// Content-Type, Transfer-Encoding), por id y por nombre
+static void runLookups(const std::string& message, double seconds) {
+	Request request;
+	BufferPool pool;
+	RecvBuffer buffer;
+	buffer.setPool(&pool);
+	if (!parseOnce(request, buffer, message, 0))
+		return;
+
+	const std::string names[4] = { "host", "connection", "content-type", "x-forwarded-for" };
+	for (int byName = 0; byName < 2; ++byName) {
+		size_t found = 0;
+		size_t iterations = 0;
+		double start = nowSeconds();
+		double elapsed = 0;
+		while (elapsed < seconds) {
+			for (int i = 0; i < 10000; ++i) {
+				if (byName) {
+					for (int n = 0; n < 4; ++n)
+						found += request.hasHeader(names[n]);
+				} else {
+					found += request.hasHeader(HEADER_HOST);
+					found += request.keepAlive();
+					found += request.hasHeader(HEADER_CONTENT_TYPE);
+					found += request.hasHeader(HEADER_TRANSFER_ENCODING);
+				}
+			}
+			iterations += 10000;
+			elapsed = nowSeconds() - start;
+		}
+		std::printf("%-28s %9s  %9.1f ns/lookup  (%lu)\n",
+					byName ? "header lookup by name" : "header lookup by id", "",
+					elapsed * 1e9 / (iterations * 4.0), static_cast<unsigned long>(found % 10));
+	}
+}
+
+// Cabecera de navegador de unos 'target' bytes: los mismos headers de
+// siempre y una cookie que crece hasta completar el tamaño
+static std::string browserHead(const char* uri, size_t target) {
+	std::string head = std::string("GET ") + uri + " HTTP/1.1\r\n"
+		"Host: www.example.com\r\n"
+		"User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+		"(KHTML, like Gecko) Chrome/130.0.0.0 Safari/537.36\r\n"
+		"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,"
+		"image/webp,*/*;q=0.8\r\n"
+		"Accept-Language: es-ES,es;q=0.9,en;q=0.8\r\n"
+		"Accept-Encoding: gzip, deflate, br, zstd\r\n"
+		"Connection: keep-alive\r\n"
+		"Upgrade-Insecure-Requests: 1\r\n"
+		"Sec-Fetch-Dest: document\r\n"
+		"Sec-Fetch-Mode: navigate\r\n"
+		"Sec-Fetch-Site: none\r\n"
+		"Sec-Fetch-User: ?1\r\n";
+	std::string cookie = "Cookie: _ga=GA1.1.1234567890.1760000000";
+	for (int i = 0; head.size() + cookie.size() + 6 < target; ++i) {
+		char pair[48];
+		std::snprintf(pair, sizeof(pair), "; pref_%d=%08x%08x", i, i * 2654435761u, i * 40503u);
+		cookie += pair;
+	}
+	return head + cookie + "\r\n\r\n";
+}
+
+int main(int argc, char** argv) {
+	double seconds = argc > 1 ? std::atof(argv[1]) : 0.5;
+
+	std::string minimal = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+	std::string browser =
+		"GET /static/app/main.css?v=20261016 HTTP/1.1\r\n"
+		"Host: www.example.com:8080\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:131.0) Gecko/20100101 Firefox/131.0\r\n"
+		"Accept: text/css,*/*;q=0.1\r\n"
+		"Accept-Language: es-ES,es;q=0.8,en-US;q=0.5,en;q=0.3\r\n"
+		"Accept-Encoding: gzip, deflate, br, zstd\r\n"
+		"Referer: http://www.example.com:8080/index.html\r\n"
+		"Connection: keep-alive\r\n"
+		"Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark; lang=es\r\n"
+		"Sec-Fetch-Dest: style\r\n"
+		"Sec-Fetch-Mode: no-cors\r\n"
+		"Sec-Fetch-Site: same-origin\r\n"
+		"If-Modified-Since: Thu, 15 Oct 2026 10:00:00 GMT\r\n"
+		"Cache-Control: max-age=0\r\n"
+		"\r\n";
+
+	std::string manyHeaders = "GET /api/items HTTP/1.1\r\nHost: localhost\r\n";
+	for (int i = 0; i < 64; ++i) {
+		char line[64];
+		std::snprintf(line, sizeof(line), "X-Custom-Header-%02d: value-%02d\r\n", i, i);
+		manyHeaders += line;
+	}
+	manyHeaders += "\r\n";
+
+	std::string post = "POST /uploads/data.bin HTTP/1.1\r\nHost: localhost\r\n"
+					   "Content-Type: application/octet-stream\r\nContent-Length: 65536\r\n\r\n";
+	post += std::string(65536, 'x');
+
+	std::string chunked = "POST /uploads/stream.bin HTTP/1.1\r\nHost: localhost\r\n"
+						  "Transfer-Encoding: chunked\r\n\r\n";
+	for (int i = 0; i < 16; ++i)
+		chunked += "1000;part=" + std::string(1, 'a' + i) + "\r\n" + std::string(4096, 'x') + "\r\n";
+	chunked += "0\r\nX-Checksum: 1234\r\n\r\n";
+
+	std::printf("%-28s %9s  %14s  %16s\n", "case", "size", "throughput", "rate");
+	runCase("minimal GET", minimal, 0, seconds);
+	runCase("browser GET", browser, 0, seconds);
+	runCase("browser GET, 16 B slices", browser, 16, seconds);
+	runCase("browser GET, 1 B slices", browser, 1, seconds);
+	runCase("64 headers", manyHeaders, 0, seconds);
+	runCase("64 headers, 16 B slices", manyHeaders, 16, seconds);
+	runCase("POST 64 KB body", post, 0, seconds);
+	runCase("POST 64 KB body, 4 KB reads", post, 4096, seconds);
+	runCase("POST 64 KB body to /tmp", post, 4096, seconds, 16 * 1024);
+	runCase("POST 64 KB chunked", chunked, 0, seconds);
+	runCase("POST 64 KB chunked, 1000 B", chunked, 1000, seconds);
+
+	runLookups(browser, seconds);
+
+	if (!kernelsAgree())
+		return 1;
+	std::string heads[3] = {
+		browserHead("/", 500),
+		browserHead("/app/dashboard?tab=overview", 1000),
+		browserHead("/shop/cart/checkout?step=2&coupon=none", 1500)
+	};
+	HttpScan::Kernel best = HttpScan::activeKernel();
+	for (int k = HttpScan::SCALAR; k <= HttpScan::AVX2; ++k) {
+		HttpScan::Kernel kernel = static_cast<HttpScan::Kernel>(k);
+		if (!HttpScan::useKernel(kernel))
+			continue;
+		std::printf("\nkernel %s%s\n", HttpScan::kernelName(kernel),
+					kernel == best ? " (default on this CPU)" : "");
+		for (size_t i = 0; i < 3; ++i) {
+			char name[32];
+			std::snprintf(name, sizeof(name), "browser head %lu B",
+						  static_cast<unsigned long>(heads[i].size()));
+			runCase(name, heads[i], 0, seconds);
+		}
+	}
+	HttpScan::useKernel(best);
+	return 0;
+}
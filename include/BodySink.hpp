@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BodySink.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 15:12:40 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 15:12:40 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BODY_SINK_HPP
+#define BODY_SINK_HPP
+
+#include <string>
+
+// Destino del body de una petición. Mientras no pase de memoryLimit se
+// guarda en memoria; a partir de ahí todo va a un fichero temporal, así
+// que un upload de 100 MB no ocupa más que el buffer de recepción. Un
+// upload termina renombrando ese fichero a su destino y un CGI lo lee
+// directamente como stdin.
+class BodySink {
+public:
+	BodySink();
+	~BodySink();
+	
+	// Se mantiene entre peticiones; reset() no lo toca
+	void configure(size_t memoryLimit, const std::string& tempDir);
+	
+	// Tamaño anunciado (Content-Length): si no va a caber en memoria se
+	// pasa a disco antes del primer byte
+	bool expect(size_t size);
+	bool append(const char* data, size_t len);
+	void reset();
+	size_t releaseBuffers(size_t maxCapacity);
+	
+	size_t size() const;
+	bool empty() const;
+	bool inMemory() const;
+	const std::string& memory() const;	// sólo con inMemory()
+	
+	// Deja el body en 'dest' (rename si el temporal está en el mismo
+	// sistema de ficheros, copia si no). El sink queda vacío.
+	bool moveTo(const std::string& dest);
+	// Descriptor de sólo lectura al inicio del fichero temporal (-1 si está
+	// en memoria o falla)
+	int openForReading() const;
+
+private:
+	size_t _memoryLimit;
+	std::string _tempDir;
+	std::string _memory;
+	int _fd;				// fichero temporal abierto, -1 si está en memoria
+	std::string _path;		// su ruta, para renombrarlo o borrarlo
+	size_t _size;
+	
+	bool spill();
+	void discardFile();
+	static bool writeAll(int fd, const char* data, size_t len);
+	
+	BodySink(const BodySink&);
+	BodySink& operator=(const BodySink&);
+};
+
+#endif
@@ -17,10 +17,17 @@
 #include "Response.hpp"
 #include "ServerConfig.hpp"
 #include "LocationConfig.hpp"
+#include "TimerWheel.hpp"
+#include "RecvBuffer.hpp"
+#include "Router.hpp"
+#include "OpenFileCache.hpp"
+#include "StaticCache.hpp"
 #include <string>
 #include <ctime>
 #include <vector>
+#include <deque>
 #include <sys/types.h>
+#include <stdint.h>
 
 enum ConnectionState {
 	READING_REQUEST,
@@ -28,20 +35,60 @@ enum ConnectionState {
 	WRITING_TO_CGI,
 	READING_FROM_CGI,
 	WRITING_RESPONSE,
+	LINGERING,		// error enviado: se descarta lo que quede del cliente antes de cerrar
 	CLOSING
 };
 
+// Qué timeout aplica a la conexión según lo que esté esperando
+enum TimeoutPhase {
+	TIMEOUT_HEADER,		// línea de petición y headers
+	TIMEOUT_BODY,		// body de la petición
+	TIMEOUT_KEEPALIVE,	// ociosa entre peticiones
+	TIMEOUT_SEND,		// enviando la respuesta
+	TIMEOUT_CGI,		// esperando al CGI
+	TIMEOUT_LINGER		// descartando lo que manda el cliente antes de cerrar
+};
+
+class ClientConnection;
+
+// Avisa al bucle de eventos de los descriptores que la conexión cierra por
+// su cuenta (socket del cliente, pipes del CGI) antes de que se reutilicen.
+class ConnectionObserver {
+public:
+	virtual ~ConnectionObserver() {}
+	virtual void onDescriptorClosing(ClientConnection* conn, int fd) = 0;
+};
+
 class ClientConnection {
 public:
 	ClientConnection(int fd);
 	~ClientConnection();
 	
+	// ConnectionPool: cerrar y vaciar para guardar el objeto, y reabrirlo
+	// con otro cliente. recycle() devuelve los bytes que retiene.
+	size_t recycle(size_t maxBuffer);
+	void reuse(int fd);
+	
 	int getFd() const;
 	ConnectionState getState() const;
+	void setObserver(ConnectionObserver* observer);
+	void setBufferPool(BufferPool* pool);
+	void setFileCache(OpenFileCache* files);
+	void setStaticCache(StaticCache* statics);
+	void setServers(const std::vector<ServerConfig>* servers);
+	void setBodyBuffering(size_t memoryLimit, const std::string& tempDir);
+	void setPipelineDepth(size_t depth);
+	void setHeaderLimits(size_t requestLine, size_t headerSize, size_t headerCount);
+	size_t getSlot() const;
+	void setSlot(size_t slot);
+	uint32_t getPeerAddress() const;
+	void setPeerAddress(uint32_t addr);
 	
 	bool readRequest();
-	bool processRequest(const std::vector<ServerConfig>& servers);
+	void serveRequests(const std::vector<ServerConfig>& servers);
 	bool writeResponse();
+	// LINGERING: lee y tira lo que llegue hasta EOF o gastar el presupuesto
+	void drainLinger();
 	
 	// CGI async methods
 	bool initCGI(const std::string& scriptPath, const Request& request,
@@ -55,34 +102,89 @@ public:
 	
 	void updateLastActivity();
 	time_t getLastActivity() const;
-	bool isTimeout(time_t timeoutSeconds) const;
+	
+	// Timeouts: el Listener programa el timer según la fase actual
+	TimerNode& getTimer();
+	TimeoutPhase getTimeoutPhase() const;
+	void handleTimeout(TimeoutPhase phase);
 	
 	bool shouldClose() const;
 	void close();
 
 private:
+	// Respuesta lista para enviar: cabecera y body en segmentos separados,
+	// que salen juntos en el mismo writev(). Si el body es un fichero
+	// (file >= 0), 'body' queda vacío y el fichero sale con sendfile(); si
+	// es una entrada de la StaticCache (cached), se envía desde ella
+	struct OutputBuffer {
+		std::string head;
+		std::string body;
+		int file;
+		size_t fileSize;
+		CachedFile* cached;
+		bool interim;	// 100 Continue: no cuenta como respuesta servida
+		
+		OutputBuffer() : file(-1), fileSize(0), cached(NULL), interim(false) {}
+		const char* bodyData() const { return cached ? cached->content.data() : body.data(); }
+		size_t bodySize() const { return cached ? cached->content.size() : body.size(); }
+		size_t size() const { return head.size() + bodySize() + fileSize; }
+	};
+	
 	int _fd;
 	ConnectionState _state;
 	Request _request;
+	Router::RoutingResult _routing;	// de _request, calculado una sola vez
+	bool _routed;
+	RecvBuffer _recv;	// bytes recibidos que el parser aún no ha consumido
 	Response _response;
-	std::string _responseBuffer;
-	size_t _responseSent;
+	std::deque<OutputBuffer> _output;	// respuestas listas, en el orden de las peticiones
+	size_t _outputSent;		// ya enviado de la primera (cabecera + body)
+	std::string _spareHead;	// buffer de cabecera de una respuesta ya enviada
+	size_t _pipelineDepth;	// máximo de respuestas en _output
+	bool _corked;			// TCP_CORK puesto mientras sale un fichero
 	time_t _lastActivity;
 	bool _shouldClose;
+	bool _closeAfterResponse;	// Connection: close -> cerrar al terminar de enviar
+	bool _lingerOnClose;	// puede quedar body sin leer: LINGERING antes de cerrar
+	size_t _lingerLeft;		// bytes que aún se descartan en LINGERING
+	size_t _requestsServed;
+	TimerNode _timer;
+	ConnectionObserver* _observer;
+	const std::vector<ServerConfig>* _servers;	// para resolver límites con sólo la cabecera
+	OpenFileCache* _files;	// las del bucle que atiende la conexión
+	StaticCache* _statics;
+	size_t _slot;		// posición en el vector de conexiones del Listener
+	uint32_t _peerAddr;	// IPv4 del cliente (orden de red), para limit_conn_per_ip
 	
 	// CGI async state
 	int _cgiPipeIn[2];   // pipeIn[1] es para escribir al CGI
 	int _cgiPipeOut[2];  // pipeOut[0] es para leer del CGI
 	pid_t _cgiPid;
 	bool _cgiActive;
-	std::string _cgiRequestBody;
-	size_t _cgiBodySent;
+	size_t _cgiBodySent;	// del body en memoria del Request
 	std::string _cgiOutput;
 	std::string _cgiContentType;
 	
+	size_t receiveWindow() const;
+	bool parseReceived();
+	bool hasPartialRequest() const;
+	const Router::RoutingResult& routeRequest(const std::vector<ServerConfig>& servers);
+	bool admitBody();
+	void sendContinue();
+	bool processRequest(const std::vector<ServerConfig>& servers);
+	void queueResponse();
+	void queueRedirect(const std::string& target);
+	void pipelineNext();
+	bool sendOutput();
+	void advanceOutput(size_t sent);
+	void clearOutput();
+	void setCork(bool on);
 	bool validateRequest(const ServerConfig* server, const LocationConfig* location);
-	std::string toLowerCase(const std::string& str) const;
 	void cleanupCGI();
+	void closeDescriptor(int& fd);
+	void sendErrorAndClose(int code, const std::string& body);
+	void startLinger();
+	static std::string errorBody(int code);
 };
 
 #endif
@@ -14,6 +14,7 @@
 #define CONFIG_PARSER_HPP
 
 #include "ServerConfig.hpp"
+#include "GlobalConfig.hpp"
 #include <string>
 #include <vector>
 
@@ -23,15 +24,20 @@ class ConfigParser{
 		
 		void parse();
 		const std::vector<ServerConfig>& getServers() const;
+		const GlobalConfig& getGlobal() const;
 
 	private:
 		std::string _filepath;
 		std::string _fileContent;
 		std::vector<ServerConfig> _servers;
+		GlobalConfig _global;
 
 		void readFile();
 		void removeComments();
+		void parseGlobalDirectives();
+		void parseGlobalDirective(const std::string& statement);
 		void splitServerBlocks();
+		static void parseListenOption(const std::string& param, ListenOptions& options);
 };
 
 
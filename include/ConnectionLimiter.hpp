@@ -0,0 +1,55 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionLimiter.hpp                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 12:37:19 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 12:37:19 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONNECTION_LIMITER_HPP
+#define CONNECTION_LIMITER_HPP
+
+#include <map>
+#include <cstddef>
+#include <stdint.h>
+#include <pthread.h>
+
+// Cuenta las conexiones abiertas del proceso (worker_connections) y las de
+// cada IP (limit_conn_per_ip). Lo comparten el hilo que acepta y los bucles
+// que cierran, así que va protegido por un mutex; sólo se toca al aceptar
+// y al cerrar.
+class ConnectionLimiter {
+public:
+	enum Verdict {
+		ADMIT,
+		OVER_GLOBAL,
+		OVER_PER_IP
+	};
+
+	ConnectionLimiter(size_t maxConnections, size_t maxPerIp);
+	~ConnectionLimiter();
+
+	Verdict admit(uint32_t addr);	// si devuelve ADMIT, cuenta la conexión
+	void release(uint32_t addr);
+
+	bool isFull() const;			// se alcanzó worker_connections
+	size_t getActive() const;
+	size_t getRejected() const;
+
+private:
+	mutable pthread_mutex_t _lock;
+	std::map<uint32_t, size_t> _perIp;
+	size_t _maxConnections;		// 0 = sin límite
+	size_t _maxPerIp;			// 0 = sin límite
+	size_t _active;
+	size_t _rejected;
+
+	ConnectionLimiter(const ConnectionLimiter&);
+	ConnectionLimiter& operator=(const ConnectionLimiter&);
+};
+
+#endif
@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionPool.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:58:05 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:58:05 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <vector>
+#include <cstddef>
+
+class ClientConnection;
+
+// Reutiliza los ClientConnection cerrados (con la capacidad de sus buffers,
+// hasta MAX_BUFFER por buffer) en lugar de hacer new/delete en cada
+// conexión. Uno por bucle de eventos: sin cerrojos.
+class ConnectionPool {
+public:
+	enum { MAX_BUFFER = 64 * 1024 };
+
+	explicit ConnectionPool(size_t maxSize);
+	~ConnectionPool();
+
+	ClientConnection* acquire(int fd);
+	void release(ClientConnection* conn);
+
+	size_t getHits() const;
+	size_t getMisses() const;
+	size_t getResidentBytes() const;	// memoria retenida por los objetos libres
+	size_t getSize() const;
+
+private:
+	std::vector<ClientConnection*> _free;
+	std::vector<size_t> _freeBytes;		// bytes retenidos por cada objeto libre
+	size_t _maxSize;
+	size_t _hits;
+	size_t _misses;
+	size_t _residentBytes;
+
+	ConnectionPool(const ConnectionPool&);
+	ConnectionPool& operator=(const ConnectionPool&);
+};
+
+#endif
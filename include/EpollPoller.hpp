@@ -0,0 +1,50 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollPoller.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef EPOLL_POLLER_HPP
+#define EPOLL_POLLER_HPP
+
+#ifdef __linux__
+
+#include "Poller.hpp"
+#include <vector>
+#include <sys/epoll.h>
+
+// Backend epoll (Linux): el kernel guarda el conjunto de interés y
+// epoll_wait sólo devuelve los descriptores listos.
+class EpollPoller : public Poller {
+public:
+	EpollPoller();
+	virtual ~EpollPoller();
+
+	bool isValid() const;
+
+	virtual bool add(int fd, int events);
+	virtual bool modify(int fd, int events);
+	virtual void remove(int fd);
+	virtual int wait(std::vector<Event>& ready, int timeoutMs);
+	virtual const char* getName() const;
+
+private:
+	int _epfd;
+	size_t _registered;
+	std::vector<epoll_event> _events;
+
+	EpollPoller(const EpollPoller&);
+	EpollPoller& operator=(const EpollPoller&);
+
+	bool control(int op, int fd, int events);
+};
+
+#endif
+
+#endif
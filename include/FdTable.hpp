@@ -0,0 +1,62 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FdTable.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:40:27 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:40:27 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FD_TABLE_HPP
+#define FD_TABLE_HPP
+
+#include <vector>
+#include <cstddef>
+
+class ClientConnection;
+
+// Qué es cada descriptor vigilado por el Listener
+enum FdRole {
+	FD_NONE,
+	FD_LISTEN,		// socket de escucha
+	FD_CLIENT,		// socket de un cliente
+	FD_CGI_IN,		// pipe hacia el stdin del CGI
+	FD_CGI_OUT,		// pipe desde el stdout del CGI
+	FD_WAKEUP,		// aviso de la cola de traspaso (modo multihilo)
+	FD_FILE_EVENTS	// inotify de la caché de ficheros abiertos
+};
+
+struct FdEntry {
+	FdRole role;
+	ClientConnection* conn;		// dueño (NULL para FD_LISTEN)
+	int events;					// eventos registrados en el poller
+	bool registered;
+	bool stale;					// cerrado durante la iteración actual
+
+	FdEntry() : role(FD_NONE), conn(NULL), events(0), registered(false), stale(false) {}
+};
+
+// Tabla densa indexada por número de descriptor: cualquier fd listo se
+// resuelve a su dueño y su papel en O(1), sin recorrer conexiones.
+class FdTable {
+public:
+	FdTable();
+
+	FdEntry& at(int fd);				// crece si hace falta
+	const FdEntry* find(int fd) const;	// NULL si el fd no está en uso
+	void release(int fd);
+
+	// Marca un fd cerrado mientras se despachan eventos, para ignorar los
+	// eventos que aún queden de él en el lote actual
+	void markStale(int fd);
+	void clearStale();
+
+private:
+	std::vector<FdEntry> _entries;
+	std::vector<int> _staleFds;
+};
+
+#endif
@@ -17,24 +17,28 @@
 #include "Response.hpp"
 #include "ServerConfig.hpp"
 #include "LocationConfig.hpp"
+#include "OpenFileCache.hpp"
+#include "StaticCache.hpp"
 
 class FileHandler {
 public:
 	static void handleGet(const Request& request, const std::string& filePath,
 						  const ServerConfig* server, const LocationConfig* location,
-						  Response& response);
+						  OpenFileCache& files, StaticCache& statics, Response& response);
 	
-	static void handlePost(const Request& request, const std::string& filePath,
+	static void handlePost(Request& request, const std::string& filePath,
 						   const ServerConfig* server, const LocationConfig* location,
-						   Response& response);
+						   OpenFileCache& files, StaticCache& statics, Response& response);
 	
 	static void handleDelete(const Request& request, const std::string& filePath,
 							 const ServerConfig* server, const LocationConfig* location,
-							 Response& response);
+							 OpenFileCache& files, StaticCache& statics, Response& response);
 
 private:
-	static void handleError(int code, const ServerConfig* server, Response& response);
-	static std::string findIndexFile(const std::string& dirPath, const std::string& index);
+	static void handleError(int code, const ServerConfig* server, OpenFileCache& files,
+							Response& response);
+	static void serveFile(const std::string& path, const FileInfo& file, const ServerConfig* server,
+						  OpenFileCache& files, StaticCache& statics, Response& response);
 };
 
 #endif
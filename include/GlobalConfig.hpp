@@ -0,0 +1,80 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   GlobalConfig.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef GLOBAL_CONFIG_HPP
+#define GLOBAL_CONFIG_HPP
+
+#include <string>
+#include <vector>
+
+// Directivas del contexto principal (fuera de cualquier bloque server {}).
+// Afectan al proceso entero y no a un servidor virtual concreto.
+class GlobalConfig {
+
+	public:
+		std::string eventEngine;	// "io_uring", "epoll" o "poll"
+		size_t workerProcesses;		// 0 = auto (uno por CPU)
+		bool workerCpuAffinity;		// fijar cada worker a una CPU
+		size_t workerThreads;		// bucles de eventos por proceso (0 = auto)
+		std::string threadBalance;	// "round_robin" o "least_conn"
+		size_t connectionPoolSize;	// conexiones cerradas guardadas por bucle (0 = sin pool)
+		size_t workerConnections;	// conexiones abiertas por worker (0 = sin límite)
+		size_t limitConnPerIp;		// conexiones abiertas por IP y worker (0 = sin límite)
+		size_t clientBodyBufferSize;	// body en memoria hasta aquí; más grande va a disco
+		std::string clientBodyTempPath;	// directorio de los temporales del body
+		size_t pipelineDepth;		// respuestas pendientes de enviar por conexión
+		size_t clientMaxRequestLine;	// línea de petición; más larga -> 414
+		size_t clientMaxHeaderSize;		// cabecera entera; más grande -> 431
+		size_t clientMaxHeaderCount;	// número de headers; más -> 431
+		size_t openFileCache;		// entradas de la caché de ficheros por bucle (0 = sin caché)
+		size_t openFileCacheValid;	// ms que se da por buena una entrada sin volver a stat()
+		bool openFileCacheEvents;	// invalidar también con inotify al cambiar un fichero
+		size_t staticCacheSize;		// bytes de contenido en memoria por bucle (0 = sin caché)
+		size_t staticCacheMaxFile;	// ficheros más grandes no se guardan
+		size_t staticCacheEntries;	// ficheros guardados como mucho
+
+		// Timeouts por fase de la conexión, en milisegundos
+		size_t clientHeaderTimeout;	// recibir la línea de petición y los headers
+		size_t clientBodyTimeout;	// entre dos lecturas del body
+		size_t keepaliveTimeout;	// conexión ociosa entre peticiones
+		size_t sendTimeout;			// entre dos escrituras de la respuesta
+		size_t cgiTimeout;			// ejecución completa del CGI
+
+		GlobalConfig();
+
+		void setEventEngine(const std::string& value);
+		void setWorkerProcesses(const std::string& value);
+		void setWorkerCpuAffinity(const std::string& value);
+		void setWorkerThreads(const std::string& value);
+		void setThreadBalance(const std::string& value);
+		void setConnectionPoolSize(const std::string& value);
+		void setWorkerConnections(const std::string& value);
+		void setLimitConnPerIp(const std::string& value);
+		void setClientBodyBufferSize(const std::string& value);
+		void setClientBodyTempPath(const std::string& value);
+		void setPipelineDepth(const std::string& value);
+		void setClientMaxRequestLine(const std::string& value);
+		void setClientMaxHeaderSize(const std::string& value);
+		void setClientMaxHeaderCount(const std::string& value);
+		void setOpenFileCache(const std::string& value);
+		void setOpenFileCacheEvents(const std::string& value);
+		// "off" o tamaño total, con max_file= y entries= opcionales
+		void setStaticCache(const std::string& value, const std::vector<std::string>& params);
+
+		size_t resolveWorkerProcesses() const;
+		size_t resolveWorkerThreads() const;
+
+		// "30", "30s", "500ms", "2m" -> milisegundos
+		static size_t parseDuration(const std::string& directive, const std::string& value);
+};
+
+#endif
@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HandoffQueue.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:31:08 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:31:08 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HANDOFF_QUEUE_HPP
+#define HANDOFF_QUEUE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+// Cliente recién aceptado: descriptor y dirección IPv4 (orden de red)
+struct AcceptedClient {
+	int fd;
+	uint32_t addr;
+};
+
+// Cola sin locks de un productor (el hilo aceptador) y un consumidor (el
+// hilo de un bucle de eventos) para pasar descriptores de clientes recién
+// aceptados. Cada push despierta al consumidor a través de un eventfd que
+// éste tiene registrado en su poller.
+class HandoffQueue {
+public:
+	explicit HandoffQueue(size_t capacity);
+	~HandoffQueue();
+
+	bool push(const AcceptedClient& client);	// sólo el productor
+	bool pop(AcceptedClient& client);			// sólo el consumidor
+	size_t size() const;
+
+	int getWakeupFd() const;
+	void drainWakeup();			// sólo el consumidor
+
+private:
+	std::vector<AcceptedClient> _slots;
+	size_t _mask;
+	size_t _head;				// siguiente a leer (lo escribe el consumidor)
+	char _pad[64];				// head y tail en líneas de caché distintas
+	size_t _tail;				// siguiente a escribir (lo escribe el productor)
+	int _wakeupFds[2];			// eventfd en [0] (y [1] == [0]); pipe si no hay eventfd
+
+	HandoffQueue(const HandoffQueue&);
+	HandoffQueue& operator=(const HandoffQueue&);
+};
+
+#endif
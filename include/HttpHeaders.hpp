@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HttpHeaders.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 16:03:27 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 16:03:27 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HTTP_HEADERS_HPP
+#define HTTP_HEADERS_HPP
+
+#include <cstddef>
+
+// Headers que el servidor mira o escribe, con un id fijo. Request los
+// resuelve una vez al parsear y Response los guarda en un hueco por id;
+// el orden del enum es el orden en que Response los escribe.
+enum HeaderId {
+	HEADER_SERVER,
+	HEADER_DATE,
+	HEADER_CONTENT_TYPE,
+	HEADER_CONTENT_LENGTH,
+	HEADER_CONTENT_RANGE,
+	HEADER_ACCEPT_RANGES,
+	HEADER_LAST_MODIFIED,
+	HEADER_ETAG,
+	HEADER_CACHE_CONTROL,
+	HEADER_LOCATION,
+	HEADER_CONNECTION,
+	HEADER_TRANSFER_ENCODING,
+	HEADER_HOST,
+	HEADER_EXPECT,
+	HEADER_IF_NONE_MATCH,
+	HEADER_IF_MODIFIED_SINCE,
+	HEADER_IF_RANGE,
+	HEADER_RANGE,
+	HEADER_ACCEPT,
+	HEADER_ACCEPT_ENCODING,
+	HEADER_AUTHORIZATION,
+	HEADER_COOKIE,
+	HEADER_REFERER,
+	HEADER_USER_AGENT,
+	HEADER_COUNT,
+	HEADER_UNKNOWN = HEADER_COUNT
+};
+
+namespace HttpHeaders {
+	// Nombre sin distinguir mayúsculas -> id (HEADER_UNKNOWN si no es
+	// ninguno). Un hash y una comparación, sin reservar memoria.
+	HeaderId lookup(const char* name, size_t len);
+	// Nombre con las mayúsculas de siempre ("Content-Length")
+	const char* name(HeaderId id);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HttpScan.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:05:10 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:05:10 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HTTP_SCAN_HPP
+#define HTTP_SCAN_HPP
+
+#include <cstddef>
+
+// Búsqueda de delimitadores en la cabecera HTTP. Cada función tiene una
+// versión escalar con tabla de clases de carácter y, en x86, versiones
+// SSE2 y AVX2 que miran 16 o 32 bytes de golpe; la que se usa se elige una
+// sola vez al arrancar según lo que anuncie la CPU (CPUID). Todas dan el
+// mismo resultado.
+namespace HttpScan {
+	enum Kernel {
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	// Primer byte de control (< 0x20 salvo HTAB, o 0x7f) en [p, end), o end.
+	// Ahí están CR y LF, así que sirve para encontrar el fin de línea y a la
+	// vez rechazar NUL o CR sueltos sin otra pasada.
+	const char* findControl(const char* p, const char* end);
+
+	// Primer byte que no es tchar (RFC 9110 5.6.2) en [p, end), o end
+	const char* findNonToken(const char* p, const char* end);
+
+	bool isToken(unsigned char c);
+	bool isControl(unsigned char c);
+
+	Kernel activeKernel();
+	const char* kernelName(Kernel kernel);
+	bool isSupported(Kernel kernel);
+	// Para el benchmark: false si la CPU no la soporta
+	bool useKernel(Kernel kernel);
+}
+
+#endif
@@ -16,33 +16,93 @@
 #include "Server.hpp"
 #include "ClientConnection.hpp"
 #include "ServerConfig.hpp"
+#include "GlobalConfig.hpp"
+#include "Poller.hpp"
+#include "FdTable.hpp"
+#include "HandoffQueue.hpp"
+#include "TimerWheel.hpp"
+#include "RecvBuffer.hpp"
+#include "ConnectionPool.hpp"
+#include "ConnectionLimiter.hpp"
+#include "OpenFileCache.hpp"
+#include "StaticCache.hpp"
 #include <vector>
-#include <poll.h>
+#include <map>
 #include <ctime>
 
-class Listener {
+// Destino de los clientes aceptados cuando este Listener sólo acepta y
+// reparte (modo multihilo). Devuelve false si no pudo entregarlo.
+class ConnectionDispatcher {
 	public:
-		Listener(const std::vector<Server*>& servers, const std::vector<ServerConfig>& configs);
+		virtual ~ConnectionDispatcher() {}
+		virtual bool dispatch(const AcceptedClient& client) = 0;
+};
+
+class Listener : public ConnectionObserver {
+	public:
+		Listener(const std::vector<Server*>& servers, const std::vector<ServerConfig>& configs,
+				 const GlobalConfig& global);
 		~Listener();
 
 		void run(); //Bucle principal de eventos
 
 		bool isListeningSocket(int fd) const;
 
+		// Modo multihilo: el aceptador reparte y cada bucle recibe por su cola
+		void setDispatcher(ConnectionDispatcher* dispatcher);
+		void attachInbox(HandoffQueue* inbox, size_t loopId);
+		void setLimiter(ConnectionLimiter* limiter);
+		size_t getActiveConnections() const;
+
+		virtual void onDescriptorClosing(ClientConnection* conn, int fd);
+
 	private:
-		std::vector<pollfd> _pollfds;
+		Poller* _poller;
+		std::vector<Poller::Event> _events;
+		FdTable _fds;
 		std::vector<Server*> _servers;
+		std::map<int, size_t> _acceptBatch;	// socket de escucha -> accept() por aviso
 		std::vector<ClientConnection*> _connections;
+		std::vector<ClientConnection*> _closing;	// retiradas, pendientes de delete
 		const std::vector<ServerConfig>* _serverConfigs;
+		const GlobalConfig* _global;
+		TimerWheel _timers;
+		BufferPool _buffers;	// buffers de recepción de las conexiones de este bucle
+		ConnectionPool _pool;	// ClientConnection cerrados listos para reutilizar
+		OpenFileCache _files;	// descriptores y stat() de los ficheros servidos
+		StaticCache _statics;	// contenido de los ficheros pequeños más pedidos
+		std::vector<TimerNode*> _expired;
+		ConnectionDispatcher* _dispatcher;
+		ConnectionLimiter* _limiter;	// compartido por los hilos del worker
+		bool _acceptPaused;				// listeners sin interés hasta que baje la carga
+		int _spareFd;					// reservado para poder aceptar con EMFILE
+		HandoffQueue* _inbox;
+		size_t _loopId;
+		size_t _activeConnections;		// leído desde el hilo aceptador
+		size_t _acceptedTotal;
+		time_t _nextStatsLog;
+
+		Listener(const Listener&);
+		Listener& operator=(const Listener&);
 
-		void setupPollFDs();
+		void registerListeningSockets();
+		void setInterest(int fd, FdRole role, ClientConnection* conn, int events);
+		void updateInterest(ClientConnection* conn, bool activity);
+		void refreshTimer(ClientConnection* conn, bool activity);
+		size_t timeoutFor(TimeoutPhase phase) const;
+		void dispatchEvents();
 		void handleNewConnection(int fd, std::vector<ClientConnection*>& newConnections);
-		void handleClientConnection(int fd, short revents);
-		void handleCGIPipe(ClientConnection* conn, int fd, short revents);
-		ClientConnection* findConnection(int fd);
-		ClientConnection* findConnectionByCGIFd(int fd);
+		void shedWithSpareFd(int listenFd);
+		void pauseAccept();
+		void resumeAcceptIfPossible();
+		void adoptConnection(ClientConnection* conn);
+		void drainInbox();
+		void logStats();
+		void handleClientConnection(ClientConnection* conn, int events);
+		void handleCGIPipe(ClientConnection* conn, FdRole role, int events);
+		void retireConnection(ClientConnection* conn);
 		void cleanupConnections();
-		void checkTimeouts();
+		void expireTimers();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Master.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 13:05:52 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 13:05:52 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MASTER_HPP
+#define MASTER_HPP
+
+#include "ServerConfig.hpp"
+#include "GlobalConfig.hpp"
+#include <vector>
+#include <ctime>
+#include <sys/types.h>
+
+// Proceso master del modo multiproceso (worker_processes > 1): lanza N
+// workers, cada uno con su Listener y sus propias copias SO_REUSEPORT de
+// los sockets de escucha, y los vuelve a lanzar si mueren.
+class Master {
+public:
+	Master(const std::vector<ServerConfig>& configs, const GlobalConfig& global);
+	~Master();
+
+	int run();
+
+	// Bucle de eventos de un worker (también el del modo de un solo proceso)
+	static int runWorker(const std::vector<ServerConfig>& configs,
+						 const GlobalConfig& global, bool reusePort);
+
+private:
+	const std::vector<ServerConfig>& _configs;
+	const GlobalConfig& _global;
+	std::vector<pid_t> _workers;
+	std::vector<time_t> _spawnTimes;
+
+	Master(const Master&);
+	Master& operator=(const Master&);
+
+	void validateSockets();
+	void spawnWorker(size_t index);
+	void shutdownWorkers();
+	void pinToCpu(size_t index);
+};
+
+#endif
@@ -0,0 +1,121 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   OpenFileCache.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 00:12:40 by luis              #+#    #+#             */
+/*   Updated: 2026/10/17 00:12:40 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OPEN_FILE_CACHE_HPP
+#define OPEN_FILE_CACHE_HPP
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <cerrno>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+
+// Lo que se sabe de una ruta: si existe, qué es y, si es un fichero
+// regular, un descriptor ya abierto (salvo si sólo se pidieron los metadatos)
+struct FileInfo {
+	int error;			// 0 si existe; si no, el errno de open() (ENOENT, EACCES...)
+	bool isDirectory;
+	size_t size;
+	time_t mtime;
+	ino_t inode;
+	int fd;				// abierto si es un fichero regular y se pidió; lo cierra la caché
+
+	FileInfo() : error(ENOENT), isDirectory(false), size(0), mtime(0), inode(0), fd(-1) {}
+
+	bool exists() const { return error == 0; }
+	bool isFile() const { return error == 0 && !isDirectory; }
+	// No existe (404), frente a existe pero no se puede abrir (403)
+	bool isMissing() const { return error == ENOENT || error == ENOTDIR; }
+};
+
+// Caché de ficheros abiertos, al estilo de open_file_cache de nginx. Guarda
+// por ruta el descriptor, tamaño, mtime, inodo y si es directorio, y también
+// las rutas que no existen. Una entrada vale 'valid' ms sin tocar el disco;
+// pasado ese tiempo se comprueba con un stat() y sólo se reabre si el
+// fichero ha cambiado. Con más de 'maxEntries' rutas se descarta la usada
+// hace más tiempo. Con eventos (inotify) una entrada se descarta además en
+// cuanto cambia el fichero o su directorio; cada directorio vigilado lleva la
+// cuenta de sus entradas y el watch se quita con la última.
+// Cada bucle de eventos tiene la suya, así que no necesita cerrojos.
+class OpenFileCache {
+public:
+	OpenFileCache();
+	~OpenFileCache();
+
+	// maxEntries 0 = sin caché: cada consulta va al disco
+	void configure(size_t maxEntries, size_t validMs, bool events);
+
+	// La referencia vale hasta la siguiente llamada a lookup() o invalidate().
+	// Sin 'open' basta un stat(): para HEAD, 304 o saber si un index existe.
+	// El descriptor se abre en la primera consulta que lo pida
+	const FileInfo& lookup(const std::string& path, bool open = true);
+	// Para los cambios que hace el propio servidor (uploads, DELETE)
+	void invalidate(const std::string& path);
+	void clear();
+
+	// Descriptor de inotify para el poller (-1 sin eventos)
+	int getEventFd() const;
+	// Descarta las entradas de los ficheros cambiados; se llama cuando el
+	// descriptor de eventos está listo
+	void processEvents();
+
+	size_t getHits() const;
+	size_t getMisses() const;
+	size_t getSize() const;
+
+private:
+	struct Entry {
+		std::string path;
+		FileInfo info;
+		uint64_t validUntil;	// TimerWheel::nowMs()
+		bool watched;			// cuenta en el watch de su directorio
+
+		Entry() : validUntil(0), watched(false) {}
+	};
+	// Watch de inotify de un directorio y cuántas entradas lo usan
+	struct DirWatch {
+		int wd;
+		size_t entries;
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string, EntryList::iterator> EntryIndex;
+
+	EntryList _entries;		// de la más reciente a la más antigua
+	EntryIndex _index;
+	size_t _maxEntries;
+	size_t _validMs;
+	int _eventFd;
+	std::map<int, std::string> _watches;	// watch de inotify -> directorio
+	std::map<std::string, DirWatch> _watchedDirs;
+	Entry _uncached;		// resultado de lookup() sin caché
+	size_t _hits;
+	size_t _misses;
+
+	OpenFileCache(const OpenFileCache&);
+	OpenFileCache& operator=(const OpenFileCache&);
+
+	static void load(FileInfo& info, const std::string& path);
+	static void probe(FileInfo& info, const std::string& path);
+	static void fill(FileInfo& info, const struct stat& st);
+	static void revalidate(FileInfo& info, const std::string& path, bool open);
+	static void release(FileInfo& info);
+	void erase(EntryIndex::iterator it);
+	void erasePrefix(const std::string& prefix);
+	bool watchDirectory(const std::string& path);
+	void unwatchDirectory(const std::string& path);
+	void dropWatches();
+};
+
+#endif
@@ -0,0 +1,40 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   PollPoller.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef POLL_POLLER_HPP
+#define POLL_POLLER_HPP
+
+#include "Poller.hpp"
+#include <vector>
+#include <poll.h>
+
+// Backend poll(): el vector de pollfd se mantiene entre iteraciones y
+// _index (indexado por fd) permite modificar/quitar entradas en O(1).
+class PollPoller : public Poller {
+public:
+	PollPoller();
+	virtual ~PollPoller();
+
+	virtual bool add(int fd, int events);
+	virtual bool modify(int fd, int events);
+	virtual void remove(int fd);
+	virtual int wait(std::vector<Event>& ready, int timeoutMs);
+	virtual const char* getName() const;
+
+private:
+	std::vector<pollfd> _pollfds;
+	std::vector<int> _index;	// fd -> posición en _pollfds, -1 si no está
+
+	static short toPollEvents(int events);
+};
+
+#endif
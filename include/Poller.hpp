@@ -0,0 +1,52 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Poller.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef POLLER_HPP
+#define POLLER_HPP
+
+#include <string>
+#include <vector>
+
+// Interfaz común de los backends de multiplexación (poll, epoll, io_uring).
+// El conjunto de interés es persistente: sólo se toca con add/modify/remove
+// cuando cambia lo que hay que vigilar de un descriptor.
+class Poller {
+public:
+	enum {
+		EVENT_READ = 1,
+		EVENT_WRITE = 2,
+		EVENT_ERROR = 4		// error o hangup (POLLERR | POLLHUP | POLLNVAL)
+	};
+
+	struct Event {
+		int fd;
+		int events;
+	};
+
+	virtual ~Poller() {}
+
+	virtual bool add(int fd, int events) = 0;
+	virtual bool modify(int fd, int events) = 0;
+	virtual void remove(int fd) = 0;
+
+	// Rellena 'ready' sólo con los descriptores listos. Devuelve cuántos hay,
+	// 0 si venció el timeout (o una señal interrumpió la espera) y -1 si falla.
+	virtual int wait(std::vector<Event>& ready, int timeoutMs) = 0;
+
+	virtual const char* getName() const = 0;
+
+	// Crea el backend pedido ("io_uring", "epoll" o "poll"); si no está
+	// disponible se baja al siguiente (io_uring -> epoll -> poll).
+	static Poller* create(const std::string& engine);
+};
+
+#endif
@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorPool.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:31:08 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:31:08 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REACTOR_POOL_HPP
+#define REACTOR_POOL_HPP
+
+#include "Listener.hpp"
+#include "HandoffQueue.hpp"
+#include "ServerConfig.hpp"
+#include "GlobalConfig.hpp"
+#include "ConnectionLimiter.hpp"
+#include <vector>
+#include <pthread.h>
+
+// Modo multihilo (worker_threads > 1): N bucles de eventos, cada uno con su
+// Listener en su propio hilo. El Listener aceptador entrega cada cliente a
+// uno de ellos y la conexión vive toda su vida en ese bucle, así que su
+// camino caliente no necesita locks.
+class ReactorPool : public ConnectionDispatcher {
+public:
+	ReactorPool(const std::vector<ServerConfig>& configs, const GlobalConfig& global,
+				size_t threads, ConnectionLimiter* limiter);
+	virtual ~ReactorPool();
+
+	void start();
+	virtual bool dispatch(const AcceptedClient& client);
+
+private:
+	std::vector<Listener*> _loops;
+	std::vector<HandoffQueue*> _queues;
+	std::vector<pthread_t> _threads;
+	bool _leastConn;
+	size_t _next;				// siguiente bucle en round-robin
+
+	ReactorPool(const ReactorPool&);
+	ReactorPool& operator=(const ReactorPool&);
+
+	size_t pickLoop();
+	static void* loopMain(void* arg);
+};
+
+#endif
@@ -0,0 +1,91 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RecvBuffer.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:41:37 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:41:37 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RECV_BUFFER_HPP
+#define RECV_BUFFER_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Bloques de memoria reciclados entre conexiones, por clases de tamaño
+// potencia de dos (4 KB .. 1 MB). Cada bucle de eventos tiene el suyo, así
+// que no necesita cerrojos.
+class BufferPool {
+public:
+	enum {
+		MIN_BLOCK = 4096,
+		MAX_BLOCK = 1024 * 1024,
+		MAX_CACHED_BYTES = 8 * 1024 * 1024	// lo que se guarda sin usar
+	};
+
+	BufferPool();
+	~BufferPool();
+
+	// Devuelve un bloque de al menos 'size' bytes; 'capacity' recibe el real
+	char* acquire(size_t size, size_t& capacity);
+	void recycle(char* block, size_t capacity);
+
+	static size_t blockSize(size_t size);
+
+private:
+	enum { CLASSES = 9 };	// 4 KB << 0 .. 4 KB << 8
+
+	std::vector<char*> _free[CLASSES];
+	size_t _cachedBytes;
+
+	BufferPool(const BufferPool&);
+	BufferPool& operator=(const BufferPool&);
+
+	static int classOf(size_t capacity);
+};
+
+// Bytes recibidos de un socket que el parser todavía no ha consumido.
+// recv() escribe al final y el parser consume desde el principio sin copiar;
+// el hueco consumido se recupera compactando antes de volver a leer.
+class RecvBuffer {
+public:
+	RecvBuffer();
+	~RecvBuffer();
+
+	void setPool(BufferPool* pool);
+
+	const char* data() const;
+	size_t size() const;
+	bool empty() const;
+	size_t capacity() const;
+
+	// Garantiza hueco libre al final para al menos 'space' bytes (sin pasar
+	// de BufferPool::MAX_BLOCK); devuelve el hueco realmente disponible
+	size_t prepare(size_t space);
+	char* writePtr();
+	void commit(size_t bytes);
+	void consume(size_t bytes);
+
+	// Devuelve el bloque al pool; sólo si no quedan bytes pendientes
+	void release();
+	// Descarta lo pendiente y devuelve el bloque
+	void reset();
+
+private:
+	BufferPool* _pool;
+	char* _block;
+	size_t _capacity;
+	size_t _start;	// primer byte sin consumir
+	size_t _end;	// fin de los datos recibidos
+
+	RecvBuffer(const RecvBuffer&);
+	RecvBuffer& operator=(const RecvBuffer&);
+
+	void reallocate(size_t capacity);
+};
+
+#endif
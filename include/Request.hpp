@@ -13,8 +13,9 @@
 #ifndef REQUEST_HPP
 #define REQUEST_HPP
 
+#include "BodySink.hpp"
+#include "HttpHeaders.hpp"
 #include <string>
-#include <map>
 #include <vector>
 
 enum RequestState {
@@ -25,14 +26,27 @@ enum RequestState {
 	ERROR
 };
 
+// Parser incremental: recuerda hasta dónde ha buscado fin de línea, así que
+// unos headers que llegan a trozos se recorren una sola vez. Los headers se
+// guardan como posiciones (offset/longitud) dentro de una copia única de la
+// cabecera, y sólo se crean strings cuando alguien pide uno. Los conocidos
+// (HttpHeaders.hpp) se resuelven a su id al parsear y se encuentran sin
+// buscar; el resto se recorre en orden.
 class Request {
 public:
 	Request();
 	~Request();
 	
-	// Parsing
-	bool parseChunk(const std::string& chunk);
+	// Parsing: consume lo que puede de los bytes recibidos y devuelve
+	// cuántos ha usado; el resto se le vuelve a pasar con más datos detrás.
+	// La cabecera no se consume hasta estar completa, y la llamada que la
+	// completa no toca el body: así se puede fijar el límite antes.
+	size_t parse(const char* data, size_t len);
+	void setBodyLimit(size_t limit);
+	void setHeaderLimits(size_t requestLine, size_t headerSize, size_t headerCount);
+	void setBodyBuffering(size_t memoryLimit, const std::string& tempDir);
 	void reset();
+	size_t releaseBuffers(size_t maxCapacity);
 	
 	// Getters
 	const std::string& getMethod() const;
@@ -40,40 +54,91 @@ public:
 	const std::string& getPath() const;
 	const std::string& getQuery() const;
 	const std::string& getVersion() const;
-	const std::string& getHeader(const std::string& key) const;
-	const std::map<std::string, std::string>& getHeaders() const;
-	const std::string& getBody() const;
+	std::string getHeader(HeaderId id) const;
+	std::string getHeader(const std::string& key) const;
+	const BodySink& getBody() const;
+	BodySink& getBody();
 	RequestState getState() const;
+	int getErrorStatus() const;
 	size_t getContentLength() const;
+	size_t getRemainingBody() const;
 	bool isComplete() const;
+	bool hasPendingData() const;
+	bool hasHeader(HeaderId id) const;
 	bool hasHeader(const std::string& key) const;
+	// Compara el valor sin distinguir mayúsculas y sin crear strings
+	bool headerEquals(HeaderId id, const char* value) const;
+	bool keepAlive() const;
 	
 	// Content type helpers
 	bool isChunked() const;
 	bool isMultipart() const;
 
 private:
+	struct Slice {
+		size_t offset;
+		size_t length;
+	};
+	struct HeaderField {
+		HeaderId id;
+		Slice name;
+		Slice value;
+	};
+	// Dónde está el decodificador de Transfer-Encoding: chunked
+	enum ChunkState {
+		CHUNK_SIZE,			// dígitos hexadecimales del tamaño
+		CHUNK_SIZE_END,		// espacios tras el tamaño: sólo puede seguir ';' o el CRLF
+		CHUNK_EXTENSION,	// ";nombre=valor" tras el tamaño, se descarta
+		CHUNK_DATA,			// datos del chunk
+		CHUNK_DATA_END,		// CRLF tras los datos
+		CHUNK_TRAILER		// trailers tras el chunk 0, se descartan
+	};
+
 	RequestState _state;
 	std::string _method;
 	std::string _uri;
 	std::string _path;
 	std::string _query;
 	std::string _version;
-	std::map<std::string, std::string> _headers;
-	std::string _body;
-	std::string _buffer;
+	std::string _head;					// línea de petición + headers, copiados de una vez
+	std::vector<HeaderField> _fields;	// posiciones dentro de _head
+	size_t _known[HEADER_COUNT];		// índice + 1 en _fields de cada id (0 = no está)
+	size_t _lineStart;					// inicio de la línea en curso (en los datos sin consumir)
+	size_t _scan;						// hasta dónde ya se buscó '\n'
+	BodySink _body;						// en memoria o en un temporal según tamaño
 	size_t _contentLength;
 	bool _chunked;
+	size_t _bodyLimit;			// client_max_body_size ya resuelto (0 = sin límite)
+	int _errorStatus;			// código a responder en estado ERROR
+	size_t _maxRequestLine;		// límites de la cabecera (414 / 431)
+	size_t _maxHeaderSize;
+	size_t _maxHeaderCount;
+	
+	// Estado del body chunked
+	ChunkState _chunkState;
+	size_t _chunkSize;			// tamaño que se está leyendo
+	size_t _chunkDigits;
+	size_t _chunkRemaining;		// bytes del chunk actual aún por llegar
+	size_t _chunkLine;			// longitud de la línea de tamaño o trailer en curso
+	bool _chunkCr;				// visto un CR, tiene que venir LF
+	size_t _trailerSize;		// bytes de trailers, que cuentan con la cabecera (431)
+	size_t _trailerCount;		// líneas de trailer, que cuentan como headers (431)
 	
 	// Parsing helpers
-	bool parseRequestLine(const std::string& line);
-	bool parseHeaders();
-	bool parseBody();
-	void parseUri();
-	std::string toLowerCase(const std::string& str) const;
-	std::string trim(const std::string& str) const;
-	void extractContentLength();
+	bool parseHead(const char* data, size_t len);
+	bool withinHeadLimits(size_t received);
+	bool parseRequestLine(const char* line, size_t len);
+	void addField(const char* data, size_t start, size_t end);
+	bool finishHead(const char* data, size_t headEnd);
+	size_t parseBody(const char* data, size_t len);
+	size_t parseChunked(const char* data, size_t len);
+	bool endChunkLine();
+	void fail(int status);
+	bool parseUri();
+	const HeaderField* findField(HeaderId id) const;
+	const HeaderField* findField(const std::string& key) const;
+	bool fieldContains(const HeaderField& field, const char* token) const;
+	int checkTransferEncoding(const HeaderField& field) const;
 };
 
 #endif
-
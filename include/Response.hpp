@@ -13,8 +13,13 @@
 #ifndef RESPONSE_HPP
 #define RESPONSE_HPP
 
+#include "HttpHeaders.hpp"
 #include <string>
-#include <map>
+#include <vector>
+#include <utility>
+#include <ctime>
+
+struct CachedFile;
 
 class Response {
 public:
@@ -22,30 +27,68 @@ public:
 	~Response();
 	
 	void setStatus(int code, const std::string& message = "");
+	void setHeader(HeaderId id, const std::string& value);
+	void setHeader(HeaderId id, const char* value);
 	void setHeader(const std::string& key, const std::string& value);
 	void setBody(const std::string& body);
 	void setBody(const char* data, size_t size);
+	// Toma el contenido de 'body' sin copiarlo; 'body' se queda con el anterior
+	void swapBody(std::string& body);
+	// Body desde un fichero abierto, del que pasa a ser dueño: sale con
+	// sendfile() sin cargarlo en memoria
+	void setBodyFile(int fd, size_t size);
+	// Entrega el fichero del body a quien lo vaya a enviar (fd -1 si no hay)
+	void takeBodyFile(int& fd, size_t& size);
+	// Body y headers de contenido (Content-Type, Content-Length,
+	// Last-Modified, ETag) de la StaticCache, sin copiarlos
+	void setCachedBody(CachedFile* file);
+	// Entrega la referencia a quien lo vaya a enviar (NULL si no hay)
+	CachedFile* takeCachedBody();
+	// Sin body pero con el Content-Length del que tendría: HEAD desde los
+	// metadatos del fichero
+	void setBodyLength(size_t size);
 	
 	int getStatus() const;
-	const std::string& getStatusMessage() const;
+	std::string getStatusMessage() const;
+	const std::string& getHeader(HeaderId id) const;
 	const std::string& getHeader(const std::string& key) const;
+	bool hasHeader(HeaderId id) const;
 	bool hasHeader(const std::string& key) const;
 	const std::string& getBody() const;
 	
-	std::string buildResponse() const;
+	// Línea de estado y headers, hasta la línea vacía, en 'out'. El body va
+	// aparte (swapBody), así no se copia para pegarlo detrás
+	void serializeHead(std::string& out) const;
 	size_t getBodySize() const;
 	
 	void clear();
+	size_t releaseBuffers(size_t maxCapacity);
+	
+	// Date compartido por todas las respuestas; el bucle de eventos lo
+	// refresca y sólo se formatea una vez por segundo
+	static void refreshDate(time_t now);
 
 private:
 	int _statusCode;
-	std::string _statusMessage;
-	std::map<std::string, std::string> _headers;
+	const char* _statusLine;		// línea de estado de la tabla, o NULL
+	std::string _statusMessage;		// texto propio cuando no hay línea
+	// Un hueco por header conocido, que conserva la capacidad del string de
+	// una respuesta a la siguiente, y los demás en orden de llegada
+	std::string _known[HEADER_COUNT];
+	bool _present[HEADER_COUNT];
+	std::vector<std::pair<std::string, std::string> > _extra;
 	std::string _body;
+	int _bodyFile;			// body en fichero, o -1
+	size_t _bodyFileSize;
+	CachedFile* _cached;	// body de la StaticCache, o NULL
+	
+	void setNumber(HeaderId id, size_t value);
+	void dropBodySources();
 	
-	std::string getDateHeader() const;
-	std::string getStatusMessageForCode(int code) const;
-	std::string toString(size_t value) const;
+	// Puede tener un descriptor propio: no se copia
+	Response(const Response&);
+	Response& operator=(const Response&);
+	size_t findExtra(const std::string& key) const;
 };
 
 #endif
@@ -16,6 +16,7 @@
 #include "ServerConfig.hpp"
 #include "LocationConfig.hpp"
 #include "Request.hpp"
+#include "OpenFileCache.hpp"
 #include <vector>
 
 class Router {
@@ -30,10 +31,25 @@ public:
 		RoutingResult() : server(NULL), location(NULL), isCGI(false) {}
 	};
 	
+	// Con 'files', un directorio se resuelve a su index consultando la caché
 	static RoutingResult route(
 		const std::vector<ServerConfig>& servers,
 		const Request& request,
-		int serverSocketFd
+		int serverSocketFd,
+		OpenFileCache* files
+	);
+	
+	// client_max_body_size que aplica (el de la location manda sobre el del
+	// server); 0 = sin límite
+	static size_t bodyLimit(
+		const ServerConfig* server,
+		const LocationConfig* location
+	);
+	
+	// allow_methods de la location (sin location o sin lista, todos)
+	static bool methodAllowed(
+		const LocationConfig* location,
+		const std::string& method
 	);
 	
 private:
@@ -54,6 +70,11 @@ private:
 		const std::string& requestPath
 	);
 	
+	static void resolveIndex(
+		RoutingResult& result,
+		OpenFileCache& files
+	);
+	
 	static bool isCGIRequest(
 		const LocationConfig* location,
 		const std::string& filePath
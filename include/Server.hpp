@@ -20,15 +20,18 @@
 
 class Server {
 public:
-	Server(const ServerConfig& config);
+	Server(const ServerConfig& config, bool reusePort = false);
 	~Server();
 
-	static int createSocket(const std::string& ipPort);
+	static int createSocket(const std::string& ipPort, bool reusePort = false, int backlog = 511);
+	static void closeAllSockets();
 	const std::vector<int>& getSockets() const;
+	const std::vector<size_t>& getAcceptBatches() const;
 
 private:
 	ServerConfig _config;
 	std::vector<int> _listenSockets;
+	std::vector<size_t> _acceptBatches;  // accept_batch de cada socket (mismo índice)
 
 	static std::map<int, int> _globalSocketMap;  // 🧠 Sockets compartidos por puerto
 	static std::map<int, std::string> _portToIpPort;  // Mapeo puerto -> ipPort original
@@ -23,6 +23,14 @@ location {}.
 string, vector, map: contenedores estándar para manejar listas y mapas de configuraciones. */
 
 
+// ⚙️ Parámetros opcionales de una directiva listen (listen 8080 backlog=511 accept_batch=64;)
+struct ListenOptions {
+    int backlog;          // cola de conexiones pendientes que se pide a listen()
+    size_t acceptBatch;   // accept() como mucho por cada aviso del poller
+
+    ListenOptions();
+};
+
 class ServerConfig {
 // 📘 Definición de la clase ServerConfig, que encapsula todos los datos de configuración de un bloque server.
 	public:
@@ -31,6 +39,9 @@ class ServerConfig {
     std::vector<std::string> listen;
 	//📡 Lista de valores de la directiva listen, por ejemplo ["127.0.0.1:8080", "localhost:3000"].
 
+    std::vector<ListenOptions> listenOptions;
+	// ⚙️ Parámetros de cada entrada de listen (misma posición en el vector).
+
     std::vector<std::string> serverNames;
 	// 🌐 Lista de nombres de dominio (server_name) que este servidor debe atender.
 
@@ -56,7 +67,7 @@ class ServerConfig {
     ServerConfig();
 	// 🔧 Constructor por defecto. Inicializa los miembros con valores seguros (lo vimos en el .cpp).
 
-    void addListen(const std::string& ipPort);
+    void addListen(const std::string& ipPort, const ListenOptions& options = ListenOptions());
 	// 📥 Añade un valor a listen.
 
     void addServerName(const std::string& name);
@@ -0,0 +1,95 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   StaticCache.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 01:04:18 by luis              #+#    #+#             */
+/*   Updated: 2026/10/17 01:04:18 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef STATIC_CACHE_HPP
+#define STATIC_CACHE_HPP
+
+#include "OpenFileCache.hpp"
+#include <list>
+#include <map>
+#include <string>
+
+// Fichero pequeño en memoria con sus headers ya escritos. Lo comparten la
+// caché y las respuestas en cola que lo envían; se libera con el último
+struct CachedFile {
+	std::string content;
+	std::string headers;	// Content-Type, Content-Length, Last-Modified y ETag
+	size_t size;
+	time_t mtime;
+	ino_t inode;
+	size_t refs;
+
+	CachedFile() : size(0), mtime(0), inode(0), refs(1) {}
+};
+
+// Caché del contenido de los ficheros estáticos pequeños más pedidos. Un
+// acierto no lee el fichero ni monta sus headers: la respuesta sale en un
+// writev() de la cabecera y el contenido guardado. Las entradas se validan
+// con lo que dice la OpenFileCache (inodo, mtime y tamaño), así que caducan
+// a la vez que ella. Se limita por bytes totales, tamaño por fichero y
+// número de entradas, descartando la usada hace más tiempo.
+// Cada bucle de eventos tiene la suya, así que no necesita cerrojos.
+class StaticCache {
+public:
+	StaticCache();
+	~StaticCache();
+
+	// maxBytes 0 = sin caché
+	void configure(size_t maxBytes, size_t maxFileSize, size_t maxEntries);
+	// Si un fichero de este tamaño puede guardarse
+	bool accepts(size_t size) const;
+
+	// Entrada de 'path' si sigue siendo 'file'; si no, NULL (y la vieja fuera)
+	CachedFile* find(const std::string& path, const FileInfo& file);
+	// Se queda con 'content' (leído de 'file') y monta sus headers. NULL si
+	// no corresponde al tamaño de 'file' (ha cambiado al leerlo)
+	CachedFile* insert(const std::string& path, const FileInfo& file, std::string& content,
+					   const char* contentType);
+	void invalidate(const std::string& path);
+	void clear();
+
+	// Referencias de las respuestas que lo envían
+	static void retain(CachedFile* file);
+	static void release(CachedFile* file);
+
+	size_t getHits() const;
+	size_t getMisses() const;
+	size_t getEvictions() const;
+	size_t getBytes() const;
+	size_t getSize() const;
+
+private:
+	struct Entry {
+		std::string path;
+		CachedFile* file;
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string, EntryList::iterator> EntryIndex;
+
+	EntryList _entries;		// de la más reciente a la más antigua
+	EntryIndex _index;
+	size_t _maxBytes;
+	size_t _maxFileSize;
+	size_t _maxEntries;
+	size_t _bytes;
+	size_t _hits;
+	size_t _misses;
+	size_t _evictions;
+
+	StaticCache(const StaticCache&);
+	StaticCache& operator=(const StaticCache&);
+
+	void erase(EntryIndex::iterator it);
+	static size_t footprint(const CachedFile* file);
+};
+
+#endif
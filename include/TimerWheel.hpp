@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 16:12:44 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 16:12:44 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+// Nodo intrusivo: va embebido en el objeto temporizado (ClientConnection),
+// así programar o cancelar no reserva memoria.
+struct TimerNode {
+	TimerNode* prev;
+	TimerNode* next;
+	uint64_t expires;	// en ticks
+	int tag;			// libre para el dueño (fase del timeout)
+	void* owner;
+
+	TimerNode() : prev(NULL), next(NULL), expires(0), tag(0), owner(NULL) {}
+	bool isPending() const { return next != NULL; }
+};
+
+// Rueda de temporizadores jerárquica: 4 niveles de 64 ranuras con ticks de
+// 100 ms (6,4 s / 7 min / 7 h / 19 días). Programar y cancelar son O(1);
+// los nodos de niveles altos bajan de nivel cuando la rueda inferior da
+// la vuelta.
+class TimerWheel {
+public:
+	TimerWheel();
+
+	void schedule(TimerNode& node, uint64_t deadlineMs);
+	void cancel(TimerNode& node);
+
+	// Avanza hasta nowMs y devuelve en 'expired' los nodos vencidos (ya
+	// desenlazados)
+	void advance(uint64_t nowMs, std::vector<TimerNode*>& expired);
+
+	// Milisegundos hasta el próximo tick en que puede vencer algo, o -1 si
+	// no hay nada programado
+	int nextTimeout(uint64_t nowMs) const;
+
+	static uint64_t nowMs();
+
+private:
+	enum {
+		LEVELS = 4,
+		SLOT_BITS = 6,
+		SLOTS = 1 << SLOT_BITS,
+		TICK_MS = 100
+	};
+
+	TimerNode _slots[LEVELS][SLOTS];	// centinelas de listas circulares
+	uint64_t _current;					// próximo tick por procesar
+	size_t _count;
+
+	TimerWheel(const TimerWheel&);
+	TimerWheel& operator=(const TimerWheel&);
+
+	void link(TimerNode& node);
+	static void unlink(TimerNode& node);
+	void cascade(int level);
+};
+
+#endif
@@ -0,0 +1,94 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   UringPoller.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:20:48 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:20:48 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef URING_POLLER_HPP
+#define URING_POLLER_HPP
+
+#ifdef __linux__
+
+#include "Poller.hpp"
+#include <vector>
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+// Backend io_uring (Linux >= 5.4, sin liburing): cada descriptor tiene un
+// POLL_ADD de un solo disparo que se vuelve a armar tras completarse. Los
+// re-armados, las bajas y la espera van juntos en un único io_uring_enter
+// por iteración.
+class UringPoller : public Poller {
+public:
+	UringPoller();
+	virtual ~UringPoller();
+
+	bool isValid() const;
+
+	virtual bool add(int fd, int events);
+	virtual bool modify(int fd, int events);
+	virtual void remove(int fd);
+	virtual int wait(std::vector<Event>& ready, int timeoutMs);
+	virtual const char* getName() const;
+
+private:
+	// Estado de cada fd vigilado, indexado por número de descriptor
+	struct Watch {
+		int events;				// interés pedido por el Listener
+		uint32_t generation;	// distingue completions de un registro anterior
+		bool registered;
+		bool armed;				// hay un POLL_ADD en vuelo
+
+		Watch() : events(0), generation(0), registered(false), armed(false) {}
+	};
+
+	int _ringFd;
+	unsigned _features;
+
+	// Anillo de envío (SQ)
+	void* _sqRing;
+	size_t _sqRingSize;
+	unsigned* _sqHead;
+	unsigned* _sqTail;
+	unsigned _sqMask;
+	unsigned _sqEntries;
+	unsigned* _sqArray;
+	io_uring_sqe* _sqes;
+	unsigned _pending;			// SQEs escritos aún no enviados al kernel
+
+	// Anillo de completions (CQ)
+	void* _cqRing;
+	size_t _cqRingSize;
+	unsigned* _cqHead;
+	unsigned* _cqTail;
+	unsigned _cqMask;
+	io_uring_cqe* _cqes;
+
+	std::vector<Watch> _watches;
+	std::vector<int> _rearm;	// fds por armar: su poll se completó o no cupo en la SQ
+	std::vector<int> _rearming;	// _rearm mientras se recorre (arm() puede añadir)
+	std::vector<uint64_t> _cancels;	// POLL_REMOVE que no cupieron en la SQ
+	std::vector<uint64_t> _retry;	// _cancels mientras se recorre
+
+	UringPoller(const UringPoller&);
+	UringPoller& operator=(const UringPoller&);
+
+	bool setup(unsigned entries);
+	void teardown();
+	Watch& watchFor(int fd);
+	io_uring_sqe* nextSqe();
+	int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, void* arg, size_t argSize);
+	void arm(int fd);
+	void disarm(int fd);
+	void cancel(uint64_t tag);
+};
+
+#endif
+
+#endif
@@ -14,15 +14,26 @@
 #define UTILS_HPP
 
 #include <string>
+#include <ctime>
+#include <sys/types.h>
 
 namespace Utils {
 	std::string urlDecode(const std::string& str);
-	std::string getMimeType(const std::string& filePath);
+	bool normalizePath(const char* data, size_t len, std::string& out);
+	const char* getMimeType(const std::string& filePath);
 	std::string generateAutoindex(const std::string& dirPath, const std::string& requestPath);
 	bool isDirectory(const std::string& path);
 	bool fileExists(const std::string& path);
 	std::string readFile(const std::string& path);
 	size_t parseSize(const std::string& sizeStr);
+	size_t trimCapacity(std::string& str, size_t maxCapacity);
+	// "Sun, 06 Nov 1994 08:49:37 GMT"
+	std::string httpDate(time_t when);
+	// Fecha en cualquiera de los tres formatos de HTTP; false si no es válida
+	bool parseHttpDate(const std::string& value, time_t& when);
+	// Validador fuerte de un fichero a partir de su inodo, mtime y tamaño:
+	// "2c41a-5f1a2b3c-1a2b"
+	std::string entityTag(ino_t inode, time_t mtime, size_t size);
 }
 
 #endif
@@ -0,0 +1,175 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BodySink.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 15:12:40 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 15:12:40 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "BodySink.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+
+// Como mucho se reserva esto de golpe aunque Content-Length anuncie más
+static const size_t RESERVE_MAX = 1024 * 1024;
+
+// Bloque para copiar el temporal cuando no se puede renombrar
+static const size_t COPY_CHUNK = 64 * 1024;
+
+BodySink::BodySink() : _memoryLimit(16 * 1024), _tempDir("/tmp"), _fd(-1), _size(0) {}
+
+BodySink::~BodySink() {
+	discardFile();
+}
+
+void BodySink::configure(size_t memoryLimit, const std::string& tempDir) {
+	_memoryLimit = memoryLimit;
+	_tempDir = tempDir;
+}
+
+bool BodySink::expect(size_t size) {
+	if (size > _memoryLimit)
+		return spill();
+	_memory.reserve(std::min(size, RESERVE_MAX));
+	return true;
+}
+
+bool BodySink::append(const char* data, size_t len) {
+	if (_fd < 0 && _memory.size() + len > _memoryLimit && !spill())
+		return false;
+	if (_fd >= 0) {
+		if (!writeAll(_fd, data, len))
+			return false;
+	} else {
+		_memory.append(data, len);
+	}
+	_size += len;
+	return true;
+}
+
+// Pasa a disco: crea el temporal y le vuelca lo que hubiera en memoria
+bool BodySink::spill() {
+	std::string pattern = _tempDir + "/webserv_body_XXXXXX";
+	std::vector<char> name(pattern.begin(), pattern.end());
+	name.push_back('\0');
+	int fd = mkstemp(&name[0]);
+	if (fd < 0)
+		return false;
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	// mkstemp lo crea 0600; como upload tiene que quedar igual que antes
+	fchmod(fd, 0644);
+	
+	_fd = fd;
+	_path = &name[0];
+	if (!writeAll(_fd, _memory.data(), _memory.size())) {
+		discardFile();
+		return false;
+	}
+	_memory.clear();
+	return true;
+}
+
+bool BodySink::writeAll(int fd, const char* data, size_t len) {
+	while (len > 0) {
+		ssize_t written = write(fd, data, len);
+		if (written <= 0)
+			return false;
+		data += written;
+		len -= written;
+	}
+	return true;
+}
+
+void BodySink::discardFile() {
+	if (_fd >= 0) {
+		close(_fd);
+		_fd = -1;
+	}
+	if (!_path.empty()) {
+		unlink(_path.c_str());
+		_path.clear();
+	}
+}
+
+void BodySink::reset() {
+	discardFile();
+	_memory.clear();
+	_size = 0;
+}
+
+size_t BodySink::releaseBuffers(size_t maxCapacity) {
+	reset();
+	if (_memory.capacity() > maxCapacity)
+		std::string().swap(_memory);
+	return _memory.capacity();
+}
+
+size_t BodySink::size() const {
+	return _size;
+}
+
+bool BodySink::empty() const {
+	return _size == 0;
+}
+
+bool BodySink::inMemory() const {
+	return _fd < 0;
+}
+
+const std::string& BodySink::memory() const {
+	return _memory;
+}
+
+bool BodySink::moveTo(const std::string& dest) {
+	if (_fd < 0) {
+		int out = open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (out < 0)
+			return false;
+		bool ok = writeAll(out, _memory.data(), _memory.size());
+		close(out);
+		reset();
+		return ok;
+	}
+	
+	close(_fd);
+	_fd = -1;
+	if (std::rename(_path.c_str(), dest.c_str()) == 0) {
+		_path.clear();
+		reset();
+		return true;
+	}
+	
+	// Distinto sistema de ficheros: copiar y borrar el temporal
+	bool ok = false;
+	int in = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+	int out = open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (in >= 0 && out >= 0) {
+		std::vector<char> chunk(COPY_CHUNK);
+		ssize_t got = 0;
+		ok = true;
+		while (ok && (got = read(in, &chunk[0], chunk.size())) > 0)
+			ok = writeAll(out, &chunk[0], got);
+		ok = ok && got == 0;
+	}
+	if (in >= 0)
+		close(in);
+	if (out >= 0)
+		close(out);
+	reset();
+	return ok;
+}
+
+int BodySink::openForReading() const {
+	if (_path.empty())
+		return -1;
+	return open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+}
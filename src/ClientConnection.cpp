@@ -17,22 +17,69 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#ifdef __linux__
+# include <sys/sendfile.h>
+#endif
+#include <csignal>
 #include <cerrno>
 #include <iostream>
 #include <cstring>
 #include <sstream>
 #include <map>
 #include <cstdlib>
+#include <algorithm>
+
+// Bytes que se leen como mucho por aviso del poller antes de dar paso al
+// resto de conexiones del bucle
+static const size_t READ_BUDGET = 256 * 1024;
+
+// Hueco libre mínimo en el buffer de recepción antes de cada recv()
+static const size_t RECV_MIN_SPACE = 2048;
+
+// Respuestas que se pasan como mucho a un writev() (dos segmentos cada una)
+static const size_t WRITEV_BATCH = 64;
+
+// Capacidad hasta la que se guarda el buffer de una cabecera ya enviada
+static const size_t SPARE_HEAD_MAX = 4096;
+
+// Bytes de fichero que se mandan como mucho por aviso del poller
+static const size_t SENDFILE_BUDGET = 512 * 1024;
+
+// Bytes que se descartan como mucho tras una respuesta de error antes de
+// cerrar; el tiempo lo limita TIMEOUT_LINGER
+static const size_t LINGER_BUDGET = 1024 * 1024;
+
+// Un tramo de 'fd' desde 'offset' al socket. En Linux sin pasar por el
+// espacio de usuario; en el resto, pread() + send() con un buffer en pila
+static ssize_t sendFileSlice(int sock, int fd, size_t offset, size_t len) {
+#ifdef __linux__
+	off_t pos = static_cast<off_t>(offset);
+	return sendfile(sock, fd, &pos, len);
+#else
+	char buffer[64 * 1024];
+	if (len > sizeof(buffer)) {
+		len = sizeof(buffer);
+	}
+	ssize_t bytes = pread(fd, buffer, len, static_cast<off_t>(offset));
+	if (bytes <= 0) {
+		return bytes;
+	}
+	return send(sock, buffer, static_cast<size_t>(bytes), 0);
+#endif
+}
 
 ClientConnection::ClientConnection(int fd) 
-	: _fd(fd), _state(READING_REQUEST), _responseSent(0), _shouldClose(false),
-	  _cgiPid(-1), _cgiActive(false), _cgiBodySent(0) {
+	: _fd(fd), _state(READING_REQUEST), _routed(false), _outputSent(0), _pipelineDepth(16), _corked(false),
+	  _shouldClose(false),
+	  _closeAfterResponse(false), _lingerOnClose(false), _lingerLeft(0), _requestsServed(0), _observer(NULL), _servers(NULL), _files(NULL),
+	  _statics(NULL), _slot(0), _peerAddr(0), _cgiPid(-1), _cgiActive(false), _cgiBodySent(0) {
 	updateLastActivity();
-	
-	// Set non-blocking
-	int flags = fcntl(_fd, F_GETFL, 0);
-	fcntl(_fd, F_SETFL, flags | O_NONBLOCK);
+	_timer.owner = this;
+	// El Listener ya lo acepta no bloqueante (accept4)
 	
 	// Initialize CGI pipes to invalid
 	_cgiPipeIn[0] = -1;
@@ -44,6 +91,42 @@ ClientConnection::ClientConnection(int fd)
 ClientConnection::~ClientConnection() {
 	cleanupCGI();
 	close();
+	clearOutput();
+}
+
+size_t ClientConnection::recycle(size_t maxBuffer) {
+	cleanupCGI();
+	close();
+	_recv.reset();
+	
+	size_t bytes = sizeof(*this);
+	bytes += _request.releaseBuffers(maxBuffer);
+	bytes += _response.releaseBuffers(maxBuffer);
+	clearOutput();
+	bytes += Utils::trimCapacity(_spareHead, maxBuffer);
+	bytes += Utils::trimCapacity(_cgiOutput, maxBuffer);
+	_cgiContentType.clear();
+	return bytes;
+}
+
+// Mismo estado que deja el constructor
+void ClientConnection::reuse(int fd) {
+	_fd = fd;
+	_state = READING_REQUEST;
+	_routed = false;
+	_response.clear();
+	clearOutput();
+	_corked = false;
+	_shouldClose = false;
+	_closeAfterResponse = false;
+	_lingerOnClose = false;
+	_lingerLeft = 0;
+	_requestsServed = 0;
+	_timer.tag = 0;
+	_slot = 0;
+	_peerAddr = 0;
+	_cgiBodySent = 0;
+	updateLastActivity();
 }
 
 int ClientConnection::getFd() const {
@@ -54,95 +137,314 @@ ConnectionState ClientConnection::getState() const {
 	return _state;
 }
 
+void ClientConnection::setObserver(ConnectionObserver* observer) {
+	_observer = observer;
+}
+
+void ClientConnection::setBufferPool(BufferPool* pool) {
+	_recv.setPool(pool);
+}
+
+void ClientConnection::setFileCache(OpenFileCache* files) {
+	_files = files;
+}
+
+void ClientConnection::setStaticCache(StaticCache* statics) {
+	_statics = statics;
+}
+
+void ClientConnection::setBodyBuffering(size_t memoryLimit, const std::string& tempDir) {
+	_request.setBodyBuffering(memoryLimit, tempDir);
+}
+
+void ClientConnection::setHeaderLimits(size_t requestLine, size_t headerSize, size_t headerCount) {
+	_request.setHeaderLimits(requestLine, headerSize, headerCount);
+}
+
+void ClientConnection::setPipelineDepth(size_t depth) {
+	_pipelineDepth = depth > 0 ? depth : 1;
+}
+
+void ClientConnection::setServers(const std::vector<ServerConfig>* servers) {
+	_servers = servers;
+}
+
+size_t ClientConnection::getSlot() const {
+	return _slot;
+}
+
+void ClientConnection::setSlot(size_t slot) {
+	_slot = slot;
+}
+
+uint32_t ClientConnection::getPeerAddress() const {
+	return _peerAddr;
+}
+
+void ClientConnection::setPeerAddress(uint32_t addr) {
+	_peerAddr = addr;
+}
+
+// Todo cierre de descriptores del proceso padre pasa por aquí para que el
+// Listener lo saque del poller antes de que el número se pueda reutilizar
+void ClientConnection::closeDescriptor(int& fd) {
+	if (fd < 0)
+		return;
+	if (_observer)
+		_observer->onDescriptorClosing(this, fd);
+	::close(fd);
+	fd = -1;
+}
+
+// Lee hasta vaciar el socket (una lectura corta) o gastar READ_BUDGET. El
+// parser consume directamente del buffer de recepción, sin copias
+// intermedias.
 bool ClientConnection::readRequest() {
-	char buffer[4096];
-	ssize_t bytes = recv(_fd, buffer, sizeof(buffer) - 1, 0);
+	size_t budget = READ_BUDGET;
 	
-    if (bytes == -1) {
-        // Error real
-        _shouldClose = true;
-        return false;
-    }
-    if (bytes == 0) {
-        // EOF/cierre de conexión
-        _shouldClose = true;
-        return false;
-    }
+	while (true) {
+		size_t space = _recv.prepare(receiveWindow());
+		if (space == 0) {
+			// Buffer al máximo sin que el parser pueda avanzar
+			sendErrorAndClose(400, "400 Bad Request");
+			return false;
+		}
+		
+		ssize_t bytes = recv(_fd, _recv.writePtr(), space, 0);
+		if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+			// Ya no queda nada en el socket, o el aviso del poller era de
+			// una lectura anterior que ya lo vació
+			break;
+		}
+		if (bytes <= 0) {
+			// EOF o error real
+			_shouldClose = true;
+			return false;
+		}
+		_recv.commit(bytes);
+		updateLastActivity();
+		if (parseReceived()) {
+			return _state == PROCESSING;
+		}
+		
+		size_t got = static_cast<size_t>(bytes);
+		if (got < space || got >= budget) {
+			break;
+		}
+		budget -= got;
+	}
+	return false;
+}
+
+// Pasa al parser lo pendiente en el buffer. Devuelve true si la petición
+// ha terminado (completa o con error ya contestado)
+bool ClientConnection::parseReceived() {
+	RequestState before = _request.getState();
+	_recv.consume(_request.parse(_recv.data(), _recv.size()));
 	
-	buffer[bytes] = '\0';
-	std::string chunk(buffer, bytes);
+	if (before != BODY && _request.getState() == BODY) {
+		// Cabecera completa: se sabe a qué server/location va antes de
+		// pasarle al parser el primero de los bytes del body
+		if (_servers && !admitBody()) {
+			return true;
+		}
+		_recv.consume(_request.parse(_recv.data(), _recv.size()));
+	}
 	
-	if (_request.parseChunk(chunk)) {
+	if (_request.getState() == ERROR) {
+		int status = _request.getErrorStatus();
+		sendErrorAndClose(status, errorBody(status));
+		return true;
+	}
+	if (_request.isComplete()) {
 		_state = PROCESSING;
-		updateLastActivity();
+		_recv.release();	// sólo si no hay nada detrás
 		return true;
 	}
-	
-	updateLastActivity();
 	return false;
 }
 
+// Cuánto hueco pedir al buffer antes de leer: dentro del body, lo que falta
+// (o lo que falta del chunk en curso), hasta un bloque máximo; si no, lo
+// mínimo, y el buffer crece solo cuando una línea no cabe
+size_t ClientConnection::receiveWindow() const {
+	if (_request.getState() == BODY) {
+		size_t remaining = _request.getRemainingBody();
+		return remaining > RECV_MIN_SPACE ? remaining : RECV_MIN_SPACE;
+	}
+	return RECV_MIN_SPACE;
+}
+
+// Se enruta una vez por petición: al completar la cabecera si trae body, y
+// si no al atenderla
+const Router::RoutingResult& ClientConnection::routeRequest(const std::vector<ServerConfig>& servers) {
+	if (!_routed) {
+		_routing = Router::route(servers, _request, _fd, _files);
+		_routed = true;
+	}
+	return _routing;
+}
+
+// Petición con body y la cabecera recién completa: lo que se vaya a rechazar
+// se contesta ya, sin leer el body (que el cliente puede no haber mandado
+// si espera el 100 Continue). Devuelve false si se ha rechazado
+bool ClientConnection::admitBody() {
+	const Router::RoutingResult& routing = routeRequest(*_servers);
+	if (!routing.server) {
+		sendErrorAndClose(500, "Internal Server Error");
+		return false;
+	}
+	
+	bool redirect = routing.location && !routing.location->redirect.empty();
+	size_t limit = Router::bodyLimit(routing.server, routing.location);
+	bool expects = _request.hasHeader(HEADER_EXPECT);
+	int status = 0;
+	if (!redirect && !Router::methodAllowed(routing.location, _request.getMethod())) {
+		status = 405;
+	} else if (limit > 0 && _request.getContentLength() > limit) {
+		status = 413;
+	} else if (expects && !_request.headerEquals(HEADER_EXPECT, "100-continue")) {
+		status = 417;
+	}
+	if (status != 0) {
+		sendErrorAndClose(status, errorBody(status));
+		return false;
+	}
+	if (redirect) {
+		// La respuesta no depende del body: sale ya y el body no se lee
+		_closeAfterResponse = true;
+		_lingerOnClose = true;
+		queueRedirect(routing.location->redirect);
+		return false;
+	}
+	
+	// El chunked no sabe su tamaño: el límite se aplica al decodificarlo
+	_request.setBodyLimit(limit);
+	
+	// HTTP/1.0 no conoce el 100, y si el body ya está llegando sobra
+	if (expects && _request.getVersion() == "HTTP/1.1" && _recv.empty()) {
+		sendContinue();
+	}
+	return true;
+}
+
+// Respuesta provisional del Expect: 100-continue. Si hay respuestas en cola
+// va detrás de ellas; si no, el buffer de envío del socket está vacío y se
+// manda directamente
+void ClientConnection::sendContinue() {
+	static const char CONTINUE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+	static const size_t CONTINUE_LEN = sizeof(CONTINUE) - 1;
+	
+	if (!_output.empty()) {
+		_output.push_back(OutputBuffer());
+		_output.back().head.assign(CONTINUE, CONTINUE_LEN);
+		_output.back().interim = true;
+		return;
+	}
+	ssize_t bytes = send(_fd, CONTINUE, CONTINUE_LEN, 0);
+	if (bytes != static_cast<ssize_t>(CONTINUE_LEN)) {
+		_shouldClose = true;
+	}
+}
+
+bool ClientConnection::hasPartialRequest() const {
+	return _request.hasPendingData() || !_recv.empty();
+}
+
+// Atiende la petición completa y, detrás de ella, las que ya estén enteras
+// en el buffer, hasta tener pipeline_depth respuestas sin enviar. Para al
+// arrancar un CGI: las respuestas salen en el orden de las peticiones
+void ClientConnection::serveRequests(const std::vector<ServerConfig>& servers) {
+	while (_state == PROCESSING) {
+		processRequest(servers);
+		if (_state != WRITING_RESPONSE) {
+			return;
+		}
+		pipelineNext();
+	}
+}
+
+// Pasa a la siguiente petición si la actual ya está en cola y cabe otra.
+// Queda en PROCESSING si estaba entera, en WRITING_RESPONSE si está a medias
+// pero hay respuestas por enviar, y en READING_REQUEST si no
+void ClientConnection::pipelineNext() {
+	if (_closeAfterResponse || _cgiActive || !_request.isComplete()
+		|| _output.size() >= _pipelineDepth) {
+		return;
+	}
+	_request.reset();
+	_routed = false;
+	_state = READING_REQUEST;
+	if (!_recv.empty()) {
+		parseReceived();
+	} else {
+		_recv.release();
+	}
+	if (_state == READING_REQUEST && !_output.empty()) {
+		_state = WRITING_RESPONSE;
+	}
+}
+
+void ClientConnection::queueRedirect(const std::string& target) {
+	_response.setStatus(301);
+	_response.setHeader(HEADER_LOCATION, target);
+	_response.setBody("");
+	queueResponse();
+}
+
+// Cierra la respuesta en curso y la pone a la cola de envío
+void ClientConnection::queueResponse() {
+	if (!_request.keepAlive()) {
+		_closeAfterResponse = true;
+	}
+	_response.setHeader(HEADER_CONNECTION, _closeAfterResponse ? "close" : "keep-alive");
+	_output.push_back(OutputBuffer());
+	OutputBuffer& entry = _output.back();
+	entry.head.swap(_spareHead);
+	_response.serializeHead(entry.head);
+	// HEAD lleva la cabecera del GET, Content-Length incluido, y nada más:
+	// clear() suelta el body que hubiera
+	if (_request.getMethod() != "HEAD") {
+		_response.takeBodyFile(entry.file, entry.fileSize);
+		entry.cached = _response.takeCachedBody();
+		_response.swapBody(entry.body);
+	}
+	_response.clear();
+	_state = WRITING_RESPONSE;
+}
+
 bool ClientConnection::processRequest(const std::vector<ServerConfig>& servers) {
-	Router::RoutingResult routing = Router::route(servers, _request, _fd);
+	const Router::RoutingResult& routing = routeRequest(servers);
 	
 	if (!routing.server) {
 		_response.setStatus(500);
 		_response.setBody("Internal Server Error");
-		_state = WRITING_RESPONSE;
-		_responseBuffer = _response.buildResponse();
+		queueResponse();
 		return true;
 	}
 	
     if (routing.location) {
         // Redirección si la location lo define
         if (!routing.location->redirect.empty()) {
-            _response.setStatus(301, "Moved Permanently");
-            _response.setHeader("Location", routing.location->redirect);
-            _response.setBody("");
-            _state = WRITING_RESPONSE;
-            _responseBuffer = _response.buildResponse();
+            queueRedirect(routing.location->redirect);
             return true;
         }
-		const std::vector<std::string>& allowed = routing.location->allowedMethods;
-		bool methodAllowed = false;
-		for (size_t i = 0; i < allowed.size(); ++i) {
-			if (allowed[i] == _request.getMethod()) {
-				methodAllowed = true;
-				break;
-			}
-		}
-		if (!methodAllowed && !allowed.empty()) {
-			_response.setStatus(405, "Method Not Allowed");
-			_response.setBody("405 Method Not Allowed");
-			_state = WRITING_RESPONSE;
-			_responseBuffer = _response.buildResponse();
-			return true;
-		}
 	}
-	
-    // Priorizar client_max_body_size de location sobre el del server
-    size_t maxBodySize = routing.server->clientMaxBodySize;
-    if (routing.location && routing.location->clientMaxBodySize > 0) {
-        maxBodySize = routing.location->clientMaxBodySize;
-    }
-    // Validar por Content-Length y también por tamaño real del cuerpo parseado
-    size_t effectiveBody = _request.getContentLength();
-    if (effectiveBody == 0) {
-        effectiveBody = _request.getBody().size();
-    }
-    if (maxBodySize > 0 && effectiveBody > maxBodySize) {
-		_response.setStatus(413, "Payload Too Large");
-		_response.setBody("413 Payload Too Large");
-		_state = WRITING_RESPONSE;
-		_responseBuffer = _response.buildResponse();
+	// Con body esto ya se comprobó en admitBody, y el tamaño se limita
+	// mientras se lee
+	if (!Router::methodAllowed(routing.location, _request.getMethod())) {
+		_response.setStatus(405);
+		_response.setBody("405 Method Not Allowed");
+		queueResponse();
 		return true;
 	}
 	
 	if (routing.isCGI) {
 		// Inicializar CGI de forma asíncrona
 		if (initCGI(routing.filePath, _request, *routing.server, routing.location)) {
-			// Si hay body para enviar, empezar escribiendo al CGI
-			if (!_cgiRequestBody.empty()) {
+			// Si hay body en memoria, empezar escribiendo al CGI; si está
+			// en disco el CGI ya lo tiene como stdin
+			if (_cgiPipeIn[1] >= 0 && !_request.getBody().empty()) {
 				_state = WRITING_TO_CGI;
 			} else {
 				// Si no hay body, empezar leyendo del CGI
@@ -151,69 +453,210 @@ bool ClientConnection::processRequest(const std::vector<ServerConfig>& servers)
 		} else {
 			_response.setStatus(500);
 			_response.setBody("CGI Execution Failed");
-			_state = WRITING_RESPONSE;
-			_responseBuffer = _response.buildResponse();
+			queueResponse();
 		}
 		return true;
 	} else {
 		if (_request.getMethod() == "GET" || _request.getMethod() == "HEAD") {
-			FileHandler::handleGet(_request, routing.filePath, routing.server, routing.location, _response);
+			FileHandler::handleGet(_request, routing.filePath, routing.server, routing.location,
+								   *_files, *_statics, _response);
 		} else if (_request.getMethod() == "POST") {
-			FileHandler::handlePost(_request, routing.filePath, routing.server, routing.location, _response);
+			FileHandler::handlePost(_request, routing.filePath, routing.server, routing.location,
+									*_files, *_statics, _response);
 		} else if (_request.getMethod() == "DELETE") {
-			FileHandler::handleDelete(_request, routing.filePath, routing.server, routing.location, _response);
+			FileHandler::handleDelete(_request, routing.filePath, routing.server, routing.location,
+									  *_files, *_statics, _response);
 		} else {
 			// Método desconocido/no implementado - retornar 501 Not Implemented
-			_response.setStatus(501, "Not Implemented");
+			_response.setStatus(501);
 			_response.setBody("501 Not Implemented");
 		}
 	}
 	
-	// Connection header
-	std::string connection = _request.getHeader("connection");
-	if (connection.empty() || toLowerCase(connection) == "keep-alive") {
-		_response.setHeader("Connection", "keep-alive");
-	} else {
-		_response.setHeader("Connection", "close");
+	queueResponse();
+	return true;
+}
+
+// Envía lo que admita el socket de las respuestas en cola. Un envío parcial
+// sigue en la próxima llamada desde _outputSent, aunque corte entre
+// segmentos. Devuelve true si la cola ha quedado vacía
+bool ClientConnection::writeResponse() {
+	if (!_output.empty() && !sendOutput()) {
+		// Error real o conexión cerrada: el poller avisó de que se podía
+		// escribir
 		_shouldClose = true;
+		return false;
 	}
 	
-	_state = WRITING_RESPONSE;
-	_responseBuffer = _response.buildResponse();
-	_responseSent = 0;
-	return true;
+	// Con hueco en la cola se sigue con lo que haya llegado detrás
+	pipelineNext();
+	if (_output.empty() && _state == WRITING_RESPONSE) {
+		if (!_closeAfterResponse) {
+			_state = READING_REQUEST;
+		} else if (_lingerOnClose) {
+			startLinger();
+		} else {
+			_state = CLOSING;
+		}
+	}
+	return _output.empty();
 }
 
-bool ClientConnection::writeResponse() {
-	if (_responseSent >= _responseBuffer.size()) {
-		if (_shouldClose) {
+// Cerrar con bytes del cliente sin leer hace que el kernel mande un RST, y
+// el cliente que sigue subiendo el body puede perder la respuesta de error
+// que aún no ha leído. Se cierra sólo el envío (FIN tras la respuesta) y se
+// descarta lo que llegue hasta que el cliente cierre, se acabe el
+// presupuesto o venza TIMEOUT_LINGER
+void ClientConnection::startLinger() {
+	setCork(false);
+	if (shutdown(_fd, SHUT_WR) != 0) {
+		_state = CLOSING;
+		return;
+	}
+	_recv.release();
+	_lingerLeft = LINGER_BUDGET;
+	_state = LINGERING;
+	drainLinger();
+}
+
+void ClientConnection::drainLinger() {
+	char buffer[16 * 1024];
+	while (_state == LINGERING) {
+		ssize_t bytes = recv(_fd, buffer, sizeof(buffer), 0);
+		if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+			return;
+		}
+		if (bytes <= 0 || static_cast<size_t>(bytes) >= _lingerLeft) {
+			// EOF, error o presupuesto gastado
 			_state = CLOSING;
-		} else {
-			_request.reset();
-			_response.clear();
-			_responseBuffer.clear();
-			_responseSent = 0;
-			_state = READING_REQUEST;
+			return;
 		}
-		return true;
+		_lingerLeft -= static_cast<size_t>(bytes);
 	}
+}
+
+// Un writev() con las respuestas en memoria (hasta WRITEV_BATCH), cada una
+// como cabecera + body, que para en la cabecera de la primera con fichero.
+// Después, si la primera de la cola ya sólo tiene fichero, un tramo de
+// SENDFILE_BUDGET con sendfile(). Cabecera y fichero salen con TCP_CORK para
+// que no viaje la cabecera sola en un paquete. Devuelve false si el socket
+// falla; -1 tras un envío que ya salió sólo indica que está lleno
+bool ClientConnection::sendOutput() {
+	bool first = true;
 	
-	ssize_t bytes = send(_fd, _responseBuffer.c_str() + _responseSent, 
-						_responseBuffer.size() - _responseSent, 0);
-	
-    if (bytes == -1) {
-        // Error real
-        _shouldClose = true;
-        return false;
-    }
-    if (bytes == 0) {
-        // EOF/cierre de conexión
-        _shouldClose = true;
-        return false;
-    }
+	if (_output.front().file < 0 || _outputSent < _output.front().head.size()) {
+		struct iovec iov[WRITEV_BATCH * 2];
+		size_t count = 0;
+		size_t skip = _outputSent;
+		size_t batch = 0;
+		bool withFile = false;
+		for (std::deque<OutputBuffer>::iterator it = _output.begin();
+			 it != _output.end() && batch < WRITEV_BATCH && !withFile; ++it, ++batch) {
+			const char* data[2] = { it->head.data(), it->bodyData() };
+			size_t sizes[2] = { it->head.size(), it->bodySize() };
+			for (int i = 0; i < 2; ++i) {
+				size_t size = sizes[i];
+				if (skip >= size) {
+					// Ya enviado (o vacío)
+					skip -= size;
+					continue;
+				}
+				iov[count].iov_base = const_cast<char*>(data[i]) + skip;
+				iov[count].iov_len = size - skip;
+				skip = 0;
+				++count;
+			}
+			withFile = it->file >= 0;
+		}
+		
+		if (withFile) {
+			setCork(true);
+		}
+		ssize_t bytes = writev(_fd, iov, static_cast<int>(count));
+		if (bytes <= 0) {
+			return false;
+		}
+		first = false;
+		advanceOutput(static_cast<size_t>(bytes));
+	}
 	
-	_responseSent += bytes;
-	return _responseSent >= _responseBuffer.size();
+	if (_output.empty()) {
+		return true;
+	}
+	OutputBuffer& front = _output.front();
+	if (front.file < 0 || _outputSent < front.head.size()) {
+		// Socket lleno, o lo siguiente está en memoria: en el próximo aviso
+		return true;
+	}
+	size_t offset = _outputSent - front.head.size();
+	size_t len = std::min(front.fileSize - offset, SENDFILE_BUDGET);
+	ssize_t bytes = sendFileSlice(_fd, front.file, offset, len);
+	if (bytes <= 0) {
+		// 0 sin nada enviado antes: el fichero ha encogido y ya no llega al
+		// Content-Length anunciado
+		return !first;
+	}
+	advanceOutput(static_cast<size_t>(bytes));
+	return true;
+}
+
+// Quita de la cola las respuestas que han salido enteras; el buffer de la
+// cabecera se guarda para la siguiente
+void ClientConnection::advanceOutput(size_t sent) {
+	while (sent > 0) {
+		OutputBuffer& front = _output.front();
+		size_t left = front.size() - _outputSent;
+		if (sent < left) {
+			_outputSent += sent;
+			break;
+		}
+		sent -= left;
+		if (front.file >= 0) {
+			::close(front.file);
+			setCork(false);
+		}
+		if (front.cached) {
+			StaticCache::release(front.cached);
+		}
+		if (!front.interim) {
+			_requestsServed++;
+		}
+		if (front.head.capacity() <= SPARE_HEAD_MAX) {
+			_spareHead.swap(front.head);
+		}
+		_output.pop_front();
+		_outputSent = 0;
+	}
+}
+
+// Vacía la cola cerrando los ficheros que no han llegado a enviarse y
+// soltando las entradas de la StaticCache
+void ClientConnection::clearOutput() {
+	for (std::deque<OutputBuffer>::iterator it = _output.begin(); it != _output.end(); ++it) {
+		if (it->file >= 0) {
+			::close(it->file);
+		}
+		if (it->cached) {
+			StaticCache::release(it->cached);
+		}
+	}
+	_output.clear();
+	_outputSent = 0;
+}
+
+// Retiene los segmentos parciales hasta quitarlo; al quitarlo sale lo que
+// quede pendiente
+void ClientConnection::setCork(bool on) {
+	if (_corked == on) {
+		return;
+	}
+	int value = on ? 1 : 0;
+#if defined(TCP_CORK)
+	setsockopt(_fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+#elif defined(TCP_NOPUSH)
+	setsockopt(_fd, IPPROTO_TCP, TCP_NOPUSH, &value, sizeof(value));
+#endif
+	_corked = on;
 }
 
 void ClientConnection::updateLastActivity() {
@@ -224,8 +667,60 @@ time_t ClientConnection::getLastActivity() const {
 	return _lastActivity;
 }
 
-bool ClientConnection::isTimeout(time_t timeoutSeconds) const {
-	return (time(NULL) - _lastActivity) > timeoutSeconds;
+TimerNode& ClientConnection::getTimer() {
+	return _timer;
+}
+
+TimeoutPhase ClientConnection::getTimeoutPhase() const {
+	if (_state == LINGERING)
+		return TIMEOUT_LINGER;
+	if (_cgiActive)
+		return TIMEOUT_CGI;
+	if (_state == WRITING_RESPONSE)
+		return TIMEOUT_SEND;
+	if (_request.getState() == BODY)
+		return TIMEOUT_BODY;
+	if (_requestsServed > 0 && !hasPartialRequest())
+		return TIMEOUT_KEEPALIVE;
+	return TIMEOUT_HEADER;
+}
+
+void ClientConnection::handleTimeout(TimeoutPhase phase) {
+	if (phase == TIMEOUT_BODY || (phase == TIMEOUT_HEADER && hasPartialRequest())) {
+		// Petición a medias (cliente lento o slowloris)
+		sendErrorAndClose(408, "408 Request Timeout");
+	} else if (phase == TIMEOUT_CGI) {
+		cleanupCGI(); // mata al CGI si sigue vivo
+		sendErrorAndClose(504, "504 Gateway Timeout");
+	} else {
+		// Ociosa sin petición empezada, cliente que no lee la respuesta o
+		// fin del LINGERING
+		close();
+	}
+}
+
+// Cuerpo de las respuestas de error que genera el parser
+std::string ClientConnection::errorBody(int code) {
+	switch (code) {
+		case 405: return "405 Method Not Allowed";
+		case 413: return "413 Payload Too Large";
+		case 414: return "414 URI Too Long";
+		case 417: return "417 Expectation Failed";
+		case 431: return "431 Request Header Fields Too Large";
+		case 501: return "501 Not Implemented";
+		default: return "400 Bad Request";
+	}
+}
+
+// Respuesta de error que cierra la conexión después de enviarse. El cliente
+// puede seguir mandando la petición rechazada: se cierra con LINGERING
+void ClientConnection::sendErrorAndClose(int code, const std::string& body) {
+	_response.clear();
+	_response.setStatus(code);
+	_response.setBody(body);
+	_closeAfterResponse = true;
+	_lingerOnClose = true;
+	queueResponse();
 }
 
 bool ClientConnection::shouldClose() const {
@@ -234,38 +729,43 @@ bool ClientConnection::shouldClose() const {
 
 void ClientConnection::close() {
 	if (_fd >= 0) {
-		::close(_fd);
-		_fd = -1;
+		closeDescriptor(_fd);
 		_shouldClose = true; // Marcar para eliminación en cleanupConnections
 	}
 }
 
-std::string ClientConnection::toLowerCase(const std::string& str) const {
-	std::string result = str;
-	for (size_t i = 0; i < result.size(); ++i) {
-		result[i] = std::tolower(result[i]);
-	}
-	return result;
-}
-
 // CGI async methods
 bool ClientConnection::initCGI(const std::string& scriptPath, const Request& request,
 								const ServerConfig& /*server*/, const LocationConfig* location) {
 	cleanupCGI(); // Limpiar cualquier CGI previo
 	
-	// Crear pipes
-	if (pipe(_cgiPipeIn) < 0 || pipe(_cgiPipeOut) < 0) {
+	// Un body que ya está en disco se le da al CGI como stdin tal cual; si
+	// está en memoria se le escribe por un pipe desde el propio Request
+	const BodySink& body = request.getBody();
+	int bodyFd = -1;
+	if (!body.inMemory()) {
+		bodyFd = body.openForReading();
+		if (bodyFd < 0) {
+			return false;
+		}
+	} else if (pipe(_cgiPipeIn) < 0) {
+		return false;
+	}
+	if (pipe(_cgiPipeOut) < 0) {
+		closeDescriptor(bodyFd);
+		cleanupCGI();
 		return false;
 	}
 	
 	// Hacer pipes no bloqueantes
-	int flags = fcntl(_cgiPipeIn[1], F_GETFL, 0);
-	fcntl(_cgiPipeIn[1], F_SETFL, flags | O_NONBLOCK);
+	int flags;
+	if (_cgiPipeIn[1] >= 0) {
+		flags = fcntl(_cgiPipeIn[1], F_GETFL, 0);
+		fcntl(_cgiPipeIn[1], F_SETFL, flags | O_NONBLOCK);
+	}
 	flags = fcntl(_cgiPipeOut[0], F_GETFL, 0);
 	fcntl(_cgiPipeOut[0], F_SETFL, flags | O_NONBLOCK);
 	
-	// Guardar body para enviar después
-	_cgiRequestBody = request.getBody();
 	_cgiBodySent = 0;
 	_cgiOutput.clear();
 	_cgiContentType = "text/html";
@@ -273,13 +773,14 @@ bool ClientConnection::initCGI(const std::string& scriptPath, const Request& req
 	// Fork
 	_cgiPid = fork();
 	if (_cgiPid < 0) {
+		closeDescriptor(bodyFd);
 		cleanupCGI();
 		return false;
 	}
 	
 	if (_cgiPid == 0) {
 		// Child process
-		dup2(_cgiPipeIn[0], STDIN_FILENO);
+		dup2(bodyFd >= 0 ? bodyFd : _cgiPipeIn[0], STDIN_FILENO);
 		dup2(_cgiPipeOut[1], STDOUT_FILENO);
 		dup2(_cgiPipeOut[1], STDERR_FILENO);
 		
@@ -288,6 +789,9 @@ bool ClientConnection::initCGI(const std::string& scriptPath, const Request& req
 		::close(_cgiPipeOut[0]);
 		::close(_cgiPipeOut[1]);
 		
+		// El worker ignora SIGPIPE y execve() lo heredaría
+		signal(SIGPIPE, SIG_DFL);
+		
 		// Build environment
 		std::vector<std::string> envVars;
 		envVars.push_back("REQUEST_METHOD=" + request.getMethod());
@@ -297,12 +801,12 @@ bool ClientConnection::initCGI(const std::string& scriptPath, const Request& req
 		envVars.push_back("PATH_INFO=" + request.getPath());
 		envVars.push_back("SERVER_SOFTWARE=webserv/1.0");
 		
-		std::string host = request.getHeader("host");
+		std::string host = request.getHeader(HEADER_HOST);
 		if (!host.empty()) {
 			envVars.push_back("HTTP_HOST=" + host);
 		}
 		
-		std::string contentType = request.getHeader("content-type");
+		std::string contentType = request.getHeader(HEADER_CONTENT_TYPE);
 		if (!contentType.empty()) {
 			envVars.push_back("CONTENT_TYPE=" + contentType);
 			std::ostringstream oss;
@@ -348,8 +852,9 @@ bool ClientConnection::initCGI(const std::string& scriptPath, const Request& req
 		exit(1);
 	} else {
 		// Parent process
-		::close(_cgiPipeIn[0]);
-		::close(_cgiPipeOut[1]);
+		closeDescriptor(bodyFd);
+		closeDescriptor(_cgiPipeIn[0]);
+		closeDescriptor(_cgiPipeOut[1]);
 		_cgiActive = true;
 		updateLastActivity();
 		return true;
@@ -361,31 +866,29 @@ bool ClientConnection::writeToCGI() {
 		return false;
 	}
 	
-	if (_cgiBodySent >= _cgiRequestBody.size()) {
+	const std::string& body = _request.getBody().memory();
+	if (_cgiBodySent >= body.size()) {
 		// Body completo enviado, cerrar pipe y cambiar a lectura
-		::close(_cgiPipeIn[1]);
-		_cgiPipeIn[1] = -1;
+		closeDescriptor(_cgiPipeIn[1]);
 		_state = READING_FROM_CGI;
 		updateLastActivity();
 		return true;
 	}
 	
 	ssize_t bytes = write(_cgiPipeIn[1], 
-						  _cgiRequestBody.c_str() + _cgiBodySent,
-						  _cgiRequestBody.size() - _cgiBodySent);
+						  body.data() + _cgiBodySent,
+						  body.size() - _cgiBodySent);
 	
 	if (bytes == -1) {
 		// Error real - cerrar y pasar a lectura
-		::close(_cgiPipeIn[1]);
-		_cgiPipeIn[1] = -1;
+		closeDescriptor(_cgiPipeIn[1]);
 		_state = READING_FROM_CGI;
 		updateLastActivity();
 		return true;
 	}
 	if (bytes == 0) {
 		// EOF - cerrar y pasar a lectura
-		::close(_cgiPipeIn[1]);
-		_cgiPipeIn[1] = -1;
+		closeDescriptor(_cgiPipeIn[1]);
 		_state = READING_FROM_CGI;
 		updateLastActivity();
 		return true;
@@ -406,8 +909,7 @@ bool ClientConnection::readFromCGI() {
 	
 	if (bytes == -1) {
 		// Error real - procesar output y finalizar
-		::close(_cgiPipeOut[0]);
-		_cgiPipeOut[0] = -1;
+		closeDescriptor(_cgiPipeOut[0]);
 		
 		// Esperar al proceso hijo
 		if (_cgiPid > 0) {
@@ -436,29 +938,16 @@ bool ClientConnection::readFromCGI() {
 		
 		// Preparar respuesta
 		_response.setStatus(200);
-		_response.setBody(_cgiOutput);
-		_response.setHeader("Content-Type", _cgiContentType);
-		
-		// Connection header
-		std::string connection = _request.getHeader("connection");
-		if (connection.empty() || toLowerCase(connection) == "keep-alive") {
-			_response.setHeader("Connection", "keep-alive");
-		} else {
-			_response.setHeader("Connection", "close");
-			_shouldClose = true;
-		}
-		
-		_state = WRITING_RESPONSE;
-		_responseBuffer = _response.buildResponse();
-		_responseSent = 0;
+		_response.swapBody(_cgiOutput);
+		_response.setHeader(HEADER_CONTENT_TYPE, _cgiContentType);
 		_cgiActive = false;
+		queueResponse();
 		updateLastActivity();
 		return true;
 	}
 	if (bytes == 0) {
 		// EOF - procesar output y finalizar
-		::close(_cgiPipeOut[0]);
-		_cgiPipeOut[0] = -1;
+		closeDescriptor(_cgiPipeOut[0]);
 		
 		// Esperar al proceso hijo
 		if (_cgiPid > 0) {
@@ -487,22 +976,10 @@ bool ClientConnection::readFromCGI() {
 		
 		// Preparar respuesta
 		_response.setStatus(200);
-		_response.setBody(_cgiOutput);
-		_response.setHeader("Content-Type", _cgiContentType);
-		
-		// Connection header
-		std::string connection = _request.getHeader("connection");
-		if (connection.empty() || toLowerCase(connection) == "keep-alive") {
-			_response.setHeader("Connection", "keep-alive");
-		} else {
-			_response.setHeader("Connection", "close");
-			_shouldClose = true;
-		}
-		
-		_state = WRITING_RESPONSE;
-		_responseBuffer = _response.buildResponse();
-		_responseSent = 0;
+		_response.swapBody(_cgiOutput);
+		_response.setHeader(HEADER_CONTENT_TYPE, _cgiContentType);
 		_cgiActive = false;
+		queueResponse();
 		updateLastActivity();
 		return true;
 	}
@@ -530,26 +1007,18 @@ pid_t ClientConnection::getCGIPid() const {
 }
 
 void ClientConnection::cleanupCGI() {
-	if (_cgiPipeIn[1] >= 0) {
-		::close(_cgiPipeIn[1]);
-		_cgiPipeIn[1] = -1;
-	}
-	if (_cgiPipeIn[0] >= 0) {
-		::close(_cgiPipeIn[0]);
-		_cgiPipeIn[0] = -1;
-	}
-	if (_cgiPipeOut[0] >= 0) {
-		::close(_cgiPipeOut[0]);
-		_cgiPipeOut[0] = -1;
-	}
-	if (_cgiPipeOut[1] >= 0) {
-		::close(_cgiPipeOut[1]);
-		_cgiPipeOut[1] = -1;
-	}
+	closeDescriptor(_cgiPipeIn[1]);
+	closeDescriptor(_cgiPipeIn[0]);
+	closeDescriptor(_cgiPipeOut[0]);
+	closeDescriptor(_cgiPipeOut[1]);
 	if (_cgiPid > 0) {
-		waitpid(_cgiPid, NULL, 0);
+		// Si el CGI sigue vivo (timeout, cliente desconectado) no esperar
+		// a que termine por su cuenta
+		if (waitpid(_cgiPid, NULL, WNOHANG) == 0) {
+			kill(_cgiPid, SIGKILL);
+			waitpid(_cgiPid, NULL, 0);
+		}
 		_cgiPid = -1;
 	}
 	_cgiActive = false;
 }
-
@@ -25,6 +25,7 @@ ConfigParser::ConfigParser(const std::string& filepath)
 void ConfigParser::parse() {
 	readFile();                    // Leer el archivo a string (_fileContent)
 	removeComments();              // Eliminar los comentarios (líneas con #)
+	parseGlobalDirectives();       // Directivas fuera de los bloques (event_engine...)
 	splitServerBlocks();           // Separar bloques server {...}
 }
 
@@ -56,6 +57,116 @@ void ConfigParser::removeComments() {
 	_fileContent = cleaned;                        // Reemplazar el contenido original sin comentarios
 }
 
+// Recorre el contexto principal (profundidad 0) y procesa cada sentencia
+// terminada en ';'. Los bloques { ... } se saltan enteros: los server {} los
+// trata splitServerBlocks().
+void ConfigParser::parseGlobalDirectives() {
+	std::string statement;
+	int depth = 0;
+
+	for (size_t i = 0; i < _fileContent.size(); ++i) {
+		char c = _fileContent[i];
+		if (c == '{') {
+			depth++;
+			statement.clear();             // "server {" no es una directiva global
+		}
+		else if (c == '}') {
+			if (depth > 0) depth--;
+		}
+		else if (depth == 0) {
+			if (c == ';') {
+				parseGlobalDirective(statement);
+				statement.clear();
+			}
+			else
+				statement += c;
+		}
+	}
+}
+
+void ConfigParser::parseGlobalDirective(const std::string& statement) {
+	std::istringstream lineStream(statement);
+	std::string directive;
+	std::string value;
+	lineStream >> directive >> value;
+
+	if (directive == "event_engine")
+		_global.setEventEngine(value);
+	else if (directive == "worker_processes")
+		_global.setWorkerProcesses(value);
+	else if (directive == "worker_cpu_affinity")
+		_global.setWorkerCpuAffinity(value);
+	else if (directive == "worker_threads")
+		_global.setWorkerThreads(value);
+	else if (directive == "thread_balance")
+		_global.setThreadBalance(value);
+	else if (directive == "connection_pool_size")
+		_global.setConnectionPoolSize(value);
+	else if (directive == "worker_connections")
+		_global.setWorkerConnections(value);
+	else if (directive == "limit_conn_per_ip")
+		_global.setLimitConnPerIp(value);
+	else if (directive == "client_body_buffer_size")
+		_global.setClientBodyBufferSize(value);
+	else if (directive == "client_body_temp_path")
+		_global.setClientBodyTempPath(value);
+	else if (directive == "pipeline_depth")
+		_global.setPipelineDepth(value);
+	else if (directive == "client_max_request_line")
+		_global.setClientMaxRequestLine(value);
+	else if (directive == "client_max_header_size")
+		_global.setClientMaxHeaderSize(value);
+	else if (directive == "client_max_header_count")
+		_global.setClientMaxHeaderCount(value);
+	else if (directive == "open_file_cache")
+		_global.setOpenFileCache(value);
+	else if (directive == "open_file_cache_valid")
+		_global.openFileCacheValid = GlobalConfig::parseDuration(directive, value);
+	else if (directive == "open_file_cache_events")
+		_global.setOpenFileCacheEvents(value);
+	else if (directive == "static_cache") {
+		std::vector<std::string> params;
+		std::string param;
+		while (lineStream >> param)
+			params.push_back(param);
+		_global.setStaticCache(value, params);
+	}
+	else if (directive == "client_header_timeout")
+		_global.clientHeaderTimeout = GlobalConfig::parseDuration(directive, value);
+	else if (directive == "client_body_timeout")
+		_global.clientBodyTimeout = GlobalConfig::parseDuration(directive, value);
+	else if (directive == "keepalive_timeout")
+		_global.keepaliveTimeout = GlobalConfig::parseDuration(directive, value);
+	else if (directive == "send_timeout")
+		_global.sendTimeout = GlobalConfig::parseDuration(directive, value);
+	else if (directive == "cgi_timeout")
+		_global.cgiTimeout = GlobalConfig::parseDuration(directive, value);
+
+	// otras directivas globales se ignorarán por ahora
+}
+
+// Parámetros nombre=valor de la directiva listen
+void ConfigParser::parseListenOption(const std::string& param, ListenOptions& options) {
+	size_t eq = param.find('=');
+	std::string name = param.substr(0, eq);
+	std::istringstream iss(param.substr(eq + 1));
+	long number = 0;
+	bool valid = (iss >> number) && iss.eof();
+
+	if (name == "backlog") {
+		if (!valid || number < 1 || number > 65535)
+			throw std::runtime_error("Error: listen backlog must be a number between 1 and 65535.");
+		options.backlog = static_cast<int>(number);
+	}
+	else if (name == "accept_batch") {
+		if (!valid || number < 1 || number > 1024)
+			throw std::runtime_error("Error: listen accept_batch must be a number between 1 and 1024.");
+		options.acceptBatch = static_cast<size_t>(number);
+	}
+	else
+		throw std::runtime_error("Error: unknown listen parameter: " + param);
+}
+
 // Divide el contenido en bloques de configuración de servidor
 void ConfigParser::splitServerBlocks() {
     size_t pos = 0;                                // Posición para recorrer el string
@@ -95,12 +206,22 @@ void ConfigParser::splitServerBlocks() {
 
 			if (directive == "listen") {                   // Si la directiva es listen
 				std::string value;
+				std::vector<std::string> addresses;
+				ListenOptions options;
 				while (lineStream >> value) {              // Leer todos los valores siguientes
 					if (!value.empty() && value[value.size() - 1] == ';')
 						value.erase(value.size() - 1);
+					if (value.empty())
+						continue;
 
-					server.addListen(value);               // Guardar valor en el objeto server
+					// Los parámetros valen para todas las direcciones de la línea
+					if (value.find('=') != std::string::npos)
+						parseListenOption(value, options);
+					else
+						addresses.push_back(value);
 				}
+				for (size_t i = 0; i < addresses.size(); ++i)
+					server.addListen(addresses[i], options); // Guardar valor en el objeto server
 			}
 			else if (directive == "server_name") {
 				std::string value;
@@ -252,3 +373,7 @@ void ConfigParser::splitServerBlocks() {
 const std::vector<ServerConfig>& ConfigParser::getServers() const {
 	return _servers;
 }
+
+const GlobalConfig& ConfigParser::getGlobal() const {
+	return _global;
+}
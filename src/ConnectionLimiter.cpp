@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionLimiter.cpp                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 12:37:19 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 12:37:19 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ConnectionLimiter.hpp"
+
+ConnectionLimiter::ConnectionLimiter(size_t maxConnections, size_t maxPerIp)
+	: _maxConnections(maxConnections), _maxPerIp(maxPerIp), _active(0), _rejected(0) {
+	pthread_mutex_init(&_lock, NULL);
+}
+
+ConnectionLimiter::~ConnectionLimiter() {
+	pthread_mutex_destroy(&_lock);
+}
+
+ConnectionLimiter::Verdict ConnectionLimiter::admit(uint32_t addr) {
+	Verdict verdict = ADMIT;
+	pthread_mutex_lock(&_lock);
+	if (_maxConnections > 0 && _active >= _maxConnections) {
+		verdict = OVER_GLOBAL;
+	} else if (_maxPerIp > 0) {
+		size_t& count = _perIp[addr];
+		if (count >= _maxPerIp)
+			verdict = OVER_PER_IP;
+		else
+			count++;
+	}
+	if (verdict == ADMIT)
+		_active++;
+	else
+		_rejected++;
+	pthread_mutex_unlock(&_lock);
+	return verdict;
+}
+
+void ConnectionLimiter::release(uint32_t addr) {
+	pthread_mutex_lock(&_lock);
+	if (_active > 0)
+		_active--;
+	if (_maxPerIp > 0) {
+		std::map<uint32_t, size_t>::iterator it = _perIp.find(addr);
+		if (it != _perIp.end() && --it->second == 0)
+			_perIp.erase(it);
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+bool ConnectionLimiter::isFull() const {
+	if (_maxConnections == 0)
+		return false;
+	return getActive() >= _maxConnections;
+}
+
+size_t ConnectionLimiter::getActive() const {
+	pthread_mutex_lock(&_lock);
+	size_t active = _active;
+	pthread_mutex_unlock(&_lock);
+	return active;
+}
+
+size_t ConnectionLimiter::getRejected() const {
+	pthread_mutex_lock(&_lock);
+	size_t rejected = _rejected;
+	pthread_mutex_unlock(&_lock);
+	return rejected;
+}
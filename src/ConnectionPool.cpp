@@ -0,0 +1,67 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionPool.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:58:05 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:58:05 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ConnectionPool.hpp"
+#include "ClientConnection.hpp"
+
+ConnectionPool::ConnectionPool(size_t maxSize)
+	: _maxSize(maxSize), _hits(0), _misses(0), _residentBytes(0) {}
+
+ConnectionPool::~ConnectionPool() {
+	for (size_t i = 0; i < _free.size(); ++i) {
+		delete _free[i];
+	}
+}
+
+ClientConnection* ConnectionPool::acquire(int fd) {
+	if (_free.empty()) {
+		_misses++;
+		return new ClientConnection(fd);
+	}
+	
+	ClientConnection* conn = _free.back();
+	_residentBytes -= _freeBytes.back();
+	_free.pop_back();
+	_freeBytes.pop_back();
+	_hits++;
+	conn->reuse(fd);
+	return conn;
+}
+
+// La conexión ya está retirada del bucle; aquí se cierra lo que le quede
+void ConnectionPool::release(ClientConnection* conn) {
+	if (_free.size() >= _maxSize) {
+		delete conn;
+		return;
+	}
+	
+	size_t bytes = conn->recycle(MAX_BUFFER);
+	_free.push_back(conn);
+	_freeBytes.push_back(bytes);
+	_residentBytes += bytes;
+}
+
+size_t ConnectionPool::getHits() const {
+	return _hits;
+}
+
+size_t ConnectionPool::getMisses() const {
+	return _misses;
+}
+
+size_t ConnectionPool::getResidentBytes() const {
+	return _residentBytes;
+}
+
+size_t ConnectionPool::getSize() const {
+	return _free.size();
+}
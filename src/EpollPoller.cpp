@@ -0,0 +1,95 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollPoller.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifdef __linux__
+
+#include "EpollPoller.hpp"
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+EpollPoller::EpollPoller() : _epfd(-1), _registered(0), _events(64) {
+	// CLOEXEC: los hijos CGI no deben heredar la instancia epoll
+	_epfd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+EpollPoller::~EpollPoller() {
+	if (_epfd >= 0)
+		close(_epfd);
+}
+
+bool EpollPoller::isValid() const {
+	return _epfd >= 0;
+}
+
+bool EpollPoller::control(int op, int fd, int events) {
+	epoll_event ev;
+	std::memset(&ev, 0, sizeof(ev));
+	if (events & EVENT_READ)
+		ev.events |= EPOLLIN;
+	if (events & EVENT_WRITE)
+		ev.events |= EPOLLOUT;
+	ev.data.fd = fd;
+	return epoll_ctl(_epfd, op, fd, &ev) == 0;
+}
+
+bool EpollPoller::add(int fd, int events) {
+	if (!control(EPOLL_CTL_ADD, fd, events))
+		return false;
+	_registered++;
+	return true;
+}
+
+bool EpollPoller::modify(int fd, int events) {
+	return control(EPOLL_CTL_MOD, fd, events);
+}
+
+void EpollPoller::remove(int fd) {
+	// Hay que quitarlo antes del close(): si otro proceso comparte el
+	// descriptor, epoll no lo daría de baja solo
+	epoll_event ev;
+	std::memset(&ev, 0, sizeof(ev));
+	if (epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev) == 0 && _registered > 0)
+		_registered--;
+}
+
+int EpollPoller::wait(std::vector<Event>& ready, int timeoutMs) {
+	ready.clear();
+
+	// Ajustar el buffer de eventos a lo que hay registrado
+	if (_events.size() < _registered && _events.size() < 4096)
+		_events.resize(_events.size() * 2);
+
+	int ret = epoll_wait(_epfd, &_events[0], _events.size(), timeoutMs);
+	if (ret < 0)
+		return errno == EINTR ? 0 : -1;
+
+	for (int i = 0; i < ret; ++i) {
+		Event ev;
+		ev.fd = _events[i].data.fd;
+		ev.events = 0;
+		if (_events[i].events & EPOLLIN)
+			ev.events |= EVENT_READ;
+		if (_events[i].events & EPOLLOUT)
+			ev.events |= EVENT_WRITE;
+		if (_events[i].events & (EPOLLERR | EPOLLHUP))
+			ev.events |= EVENT_ERROR;
+		ready.push_back(ev);
+	}
+	return ret;
+}
+
+const char* EpollPoller::getName() const {
+	return "epoll";
+}
+
+#endif
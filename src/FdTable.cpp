@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FdTable.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:40:27 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:40:27 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "FdTable.hpp"
+
+FdTable::FdTable() : _entries(1024) {}
+
+FdEntry& FdTable::at(int fd) {
+	if (static_cast<size_t>(fd) >= _entries.size()) {
+		size_t size = _entries.size();
+		while (size <= static_cast<size_t>(fd))
+			size *= 2;
+		_entries.resize(size);
+	}
+	return _entries[fd];
+}
+
+const FdEntry* FdTable::find(int fd) const {
+	if (fd < 0 || static_cast<size_t>(fd) >= _entries.size())
+		return NULL;
+	const FdEntry& entry = _entries[fd];
+	if (entry.role == FD_NONE || entry.stale)
+		return NULL;
+	return &entry;
+}
+
+void FdTable::release(int fd) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _entries.size())
+		return;
+	bool stale = _entries[fd].stale;
+	_entries[fd] = FdEntry();
+	_entries[fd].stale = stale;
+}
+
+void FdTable::markStale(int fd) {
+	if (fd < 0)
+		return;
+	FdEntry& entry = at(fd);
+	if (!entry.stale) {
+		entry.stale = true;
+		_staleFds.push_back(fd);
+	}
+}
+
+void FdTable::clearStale() {
+	for (size_t i = 0; i < _staleFds.size(); ++i)
+		_entries[_staleFds[i]].stale = false;
+	_staleFds.clear();
+}
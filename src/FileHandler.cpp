@@ -12,89 +12,206 @@
 
 #include "FileHandler.hpp"
 #include "Utils.hpp"
-#include <fstream>
 #include <sstream>
 #include <sys/stat.h>
 #include <ctime>
 #include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Por debajo de este tamaño el fichero se lee a memoria: sale en el mismo
+// writev() que la cabecera y no ocupa un descriptor mientras espera en cola
+static const size_t SENDFILE_MIN = 16 * 1024;
+
+// Lee entero un fichero de la caché sin mover su offset (el descriptor es
+// compartido). Si ha encogido desde el fstat() se queda con lo que haya
+static bool readContent(const FileInfo& file, std::string& content) {
+	content.resize(file.size);
+	size_t done = 0;
+	while (done < file.size) {
+		ssize_t bytes = pread(file.fd, &content[done], file.size - done, static_cast<off_t>(done));
+		if (bytes < 0) {
+			return false;
+		}
+		if (bytes == 0) {
+			break;
+		}
+		done += static_cast<size_t>(bytes);
+	}
+	content.resize(done);
+	return true;
+}
+
+// Alguna de las etiquetas de If-None-Match ("*" o una lista) es la del
+// fichero. Comparación débil, como pide el RFC para GET y HEAD: W/ no cuenta
+static bool matchesEntityTag(const std::string& list, const std::string& etag) {
+	size_t pos = 0;
+	while (pos < list.size()) {
+		pos = list.find_first_not_of(" \t,", pos);
+		if (pos == std::string::npos) {
+			break;
+		}
+		if (list[pos] == '*') {
+			return true;
+		}
+		if (list.compare(pos, 2, "W/") == 0) {
+			pos += 2;
+		}
+		size_t end = pos < list.size() && list[pos] == '"' ? list.find('"', pos + 1) : std::string::npos;
+		if (end == std::string::npos) {
+			return false;
+		}
+		if (list.compare(pos, end + 1 - pos, etag) == 0) {
+			return true;
+		}
+		pos = end + 1;
+	}
+	return false;
+}
+
+// If-None-Match manda sobre If-Modified-Since; una fecha inválida o futura
+// se ignora
+static bool notModified(const Request& request, const FileInfo& file) {
+	if (request.hasHeader(HEADER_IF_NONE_MATCH)) {
+		return matchesEntityTag(request.getHeader(HEADER_IF_NONE_MATCH),
+								Utils::entityTag(file.inode, file.mtime, file.size));
+	}
+	time_t since = 0;
+	return request.hasHeader(HEADER_IF_MODIFIED_SINCE)
+		&& Utils::parseHttpDate(request.getHeader(HEADER_IF_MODIFIED_SINCE), since)
+		&& since <= time(NULL) && file.mtime <= since;
+}
+
+// Last-Modified y ETag del fichero, los mismos que guarda la StaticCache
+static void setValidators(const FileInfo& file, Response& response) {
+	response.setHeader(HEADER_LAST_MODIFIED, Utils::httpDate(file.mtime));
+	response.setHeader(HEADER_ETAG, Utils::entityTag(file.inode, file.mtime, file.size));
+}
 
 void FileHandler::handleGet(const Request& request, const std::string& filePath,
 							const ServerConfig* server, const LocationConfig* location,
-							Response& response) {
+							OpenFileCache& files, StaticCache& statics, Response& response) {
+	
+	// HEAD y las peticiones condicionales pueden acabar sin body: basta con
+	// los metadatos, y el fichero sólo se abre si hay que enviarlo
+	bool head = request.getMethod() == "HEAD";
+	bool conditional = request.hasHeader(HEADER_IF_NONE_MATCH)
+		|| request.hasHeader(HEADER_IF_MODIFIED_SINCE);
+	bool openFile = !head && !conditional;
+	
+	// Todo lo que se sabe del fichero sale de la caché: sin stat() si ya se
+	// sirvió hace poco
+	FileInfo file = files.lookup(filePath, openFile);
 	
 	// Check if filePath is a directory first (before checking if file exists)
 	// This handles the case where buildFilePath might return index.html but we want directory listing
-	std::string actualPath = filePath;
-	if (location && location->autoindex && Utils::isDirectory(filePath)) {
+	if (location && location->autoindex && file.isDirectory) {
 		// Force directory path (remove index.html if present)
 		if (filePath.find("index.html") != std::string::npos) {
 			size_t idxPos = filePath.find("index.html");
-			actualPath = filePath.substr(0, idxPos);
+			std::string actualPath = filePath.substr(0, idxPos);
 			// Remove trailing slash if any
 			if (actualPath.length() > 0 && actualPath[actualPath.length() - 1] == '/') {
 				actualPath = actualPath.substr(0, actualPath.length() - 1);
 			}
+			file = files.lookup(actualPath, openFile);
 		}
 	}
 	
-	if (!Utils::fileExists(actualPath) && !Utils::isDirectory(actualPath)) {
-		handleError(404, server, response);
+	if (!file.exists()) {
+		handleError(file.isMissing() ? 404 : 403, server, files, response);
 		return;
 	}
 	
-	if (Utils::isDirectory(actualPath)) {
+	if (file.isDirectory) {
 		// If autoindex is enabled, show directory listing (priority)
 		if (location && location->autoindex) {
 			std::string autoindex = Utils::generateAutoindex(filePath, request.getPath());
 			response.setStatus(200);
-			response.setBody(autoindex);
-			response.setHeader("Content-Type", "text/html; charset=utf-8");
+			response.swapBody(autoindex);
+			response.setHeader(HEADER_CONTENT_TYPE, "text/html; charset=utf-8");
 			return;
 		}
 		
-		// Otherwise, try to serve index file
-		std::string indexFile = findIndexFile(filePath, server->index);
-		if (!indexFile.empty() && Utils::fileExists(indexFile)) {
-			// Serve the index file directly
-			std::string content = Utils::readFile(indexFile);
-			response.setStatus(200);
-			response.setBody(content);
-			response.setHeader("Content-Type", Utils::getMimeType(indexFile));
-			return;
-		}
-		
-		// No index file and no autoindex - forbidden
-		handleError(403, server, response);
+		// El Router ya cambia un directorio con index por su index: sin
+		// index ni autoindex - forbidden
+		handleError(403, server, files, response);
 		return;
 	}
 	
-	if (!Utils::fileExists(filePath)) {
-		handleError(404, server, response);
+	if (conditional && notModified(request, file)) {
+		response.setStatus(304);
+		setValidators(file, response);
+		return;
+	}
+	if (head) {
+		response.setStatus(200);
+		response.setBodyLength(file.size);
+		response.setHeader(HEADER_CONTENT_TYPE, Utils::getMimeType(filePath));
+		setValidators(file, response);
 		return;
 	}
+	if (!openFile) {
+		// Condicional que no se cumple: ahora sí hace falta el descriptor
+		file = files.lookup(filePath);
+		if (!file.isFile()) {
+			handleError(file.isMissing() ? 404 : 403, server, files, response);
+			return;
+		}
+	}
 	
-	std::string content = Utils::readFile(filePath);
-	response.setStatus(200);
-	response.setBody(content);
-	response.setHeader("Content-Type", Utils::getMimeType(filePath));
+	serveFile(filePath, file, server, files, statics, response);
 }
 
-void FileHandler::handlePost(const Request& request, const std::string& filePath,
-							  const ServerConfig* server, const LocationConfig* location,
-							  Response& response) {
-    // Enforce client_max_body_size (location overrides server)
-    size_t limit = 0;
-    if (server) {
-        limit = server->clientMaxBodySize;
-    }
-    if (location && location->clientMaxBodySize > 0) {
-        limit = location->clientMaxBodySize;
-    }
-    if (limit > 0 && request.getBody().size() > limit) {
-        handleError(413, server, response);
-        return;
-    }
+// Los ficheros pequeños ya pedidos salen de la StaticCache, con los headers
+// hechos. El resto pasa a memoria si es pequeño o sale con sendfile() por
+// tramos desde una copia del descriptor de la caché, así una descarga no
+// ocupa memoria según su tamaño y sigue siendo válida aunque la caché cierre
+// el suyo
+void FileHandler::serveFile(const std::string& path, const FileInfo& file, const ServerConfig* server,
+							OpenFileCache& files, StaticCache& statics, Response& response) {
+	std::string content;
+	if (statics.accepts(file.size)) {
+		CachedFile* cached = statics.find(path, file);
+		if (!cached) {
+			if (!readContent(file, content)) {
+				handleError(500, server, files, response);
+				return;
+			}
+			cached = statics.insert(path, file, content, Utils::getMimeType(path));
+		}
+		if (cached) {
+			response.setStatus(200);
+			response.setCachedBody(cached);
+			return;
+		}
+		// Ha cambiado mientras se leía: no se guarda y sale tal cual
+		response.swapBody(content);
+	} else if (file.size >= SENDFILE_MIN) {
+		int fd = fcntl(file.fd, F_DUPFD_CLOEXEC, 0);
+		if (fd < 0) {
+			handleError(500, server, files, response);
+			return;
+		}
+		response.setBodyFile(fd, file.size);
+	} else {
+		if (!readContent(file, content)) {
+			handleError(500, server, files, response);
+			return;
+		}
+		// El contenido pasa al Response, y de ahí a la cola de envío, sin copias
+		response.swapBody(content);
+	}
+	response.setStatus(200);
+	response.setHeader(HEADER_CONTENT_TYPE, Utils::getMimeType(path));
+	setValidators(file, response);
+}
 
+// client_max_body_size ya se aplicó al leer la cabecera (Content-Length) o
+// al decodificar el chunked: aquí el body cabe
+void FileHandler::handlePost(Request& request, const std::string& filePath,
+							  const ServerConfig* server, const LocationConfig* /*location*/,
+							  OpenFileCache& files, StaticCache& statics, Response& response) {
 	std::string uploadPath = filePath;
 	if (Utils::isDirectory(filePath)) {
 		std::ostringstream oss;
@@ -102,53 +219,57 @@ void FileHandler::handlePost(const Request& request, const std::string& filePath
 		uploadPath = oss.str();
 	}
 	
-	std::ofstream file(uploadPath.c_str(), std::ios::binary);
-	if (!file.is_open()) {
-		handleError(500, server, response);
+	// Un body grande ya está en un temporal: se renombra en vez de copiarlo
+	if (!request.getBody().moveTo(uploadPath)) {
+		handleError(500, server, files, response);
 		return;
 	}
-	
-	file.write(request.getBody().c_str(), request.getBody().size());
-	file.close();
+	// Las cachés pueden tener la ruta como inexistente o con el contenido viejo
+	files.invalidate(uploadPath);
+	statics.invalidate(uploadPath);
 	
 	response.setStatus(201);
 	response.setBody("File uploaded successfully");
-	response.setHeader("Location", uploadPath);
+	response.setHeader(HEADER_LOCATION, uploadPath);
 }
 
 void FileHandler::handleDelete(const Request& /*request*/, const std::string& filePath,
 								const ServerConfig* server, const LocationConfig* /*location*/,
-								Response& response) {
+								OpenFileCache& files, StaticCache& statics, Response& response) {
 	
 	if (!Utils::fileExists(filePath)) {
-		handleError(404, server, response);
+		handleError(404, server, files, response);
 		return;
 	}
 	
 	if (Utils::isDirectory(filePath)) {
-		handleError(403, server, response);
+		handleError(403, server, files, response);
 		return;
 	}
 	
 	if (std::remove(filePath.c_str()) == 0) {
+		files.invalidate(filePath);
+		statics.invalidate(filePath);
 		response.setStatus(204);
 		response.setBody("");
 	} else {
-		handleError(500, server, response);
+		handleError(500, server, files, response);
 	}
 }
 
-void FileHandler::handleError(int code, const ServerConfig* server, Response& response) {
+void FileHandler::handleError(int code, const ServerConfig* server, OpenFileCache& files,
+							  Response& response) {
 	response.setStatus(code);
 	
 	if (server) {
 		std::map<int, std::string>::const_iterator it = server->errorPages.find(code);
 		if (it != server->errorPages.end()) {
 			std::string errorPath = server->root + it->second;
-			if (Utils::fileExists(errorPath)) {
-				std::string content = Utils::readFile(errorPath);
-				response.setBody(content);
-				response.setHeader("Content-Type", "text/html; charset=utf-8");
+			const FileInfo& page = files.lookup(errorPath);
+			std::string content;
+			if (page.isFile() && readContent(page, content)) {
+				response.swapBody(content);
+				response.setHeader(HEADER_CONTENT_TYPE, "text/html; charset=utf-8");
 				return;
 			}
 		}
@@ -158,16 +279,5 @@ void FileHandler::handleError(int code, const ServerConfig* server, Response& re
 	oss << "<html><head><title>" << code << " Error</title></head>";
 	oss << "<body><h1>" << code << " Error</h1></body></html>";
 	response.setBody(oss.str());
-	response.setHeader("Content-Type", "text/html; charset=utf-8");
-}
-
-std::string FileHandler::findIndexFile(const std::string& dirPath, const std::string& index) {
-	if (index.empty()) {
-		if (Utils::fileExists(dirPath + "/index.html")) {
-			return dirPath + "/index.html";
-		}
-		return "";
-	}
-	return dirPath + "/" + index;
+	response.setHeader(HEADER_CONTENT_TYPE, "text/html; charset=utf-8");
 }
-
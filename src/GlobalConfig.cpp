@@ -0,0 +1,223 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   GlobalConfig.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "GlobalConfig.hpp"
+#include "Utils.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+#include <unistd.h>
+
+GlobalConfig::GlobalConfig()
+#ifdef __linux__
+	: eventEngine("epoll"),
+#else
+	: eventEngine("poll"),
+#endif
+	  workerProcesses(1), workerCpuAffinity(false), workerThreads(1),
+	  threadBalance("round_robin"), connectionPoolSize(256),
+	  workerConnections(0), limitConnPerIp(0),
+	  clientBodyBufferSize(16 * 1024), clientBodyTempPath("/tmp"),
+	  pipelineDepth(16), clientMaxRequestLine(8 * 1024),
+	  clientMaxHeaderSize(32 * 1024), clientMaxHeaderCount(100),
+	  openFileCache(1024), openFileCacheValid(5000), openFileCacheEvents(false),
+	  staticCacheSize(8 * 1024 * 1024), staticCacheMaxFile(64 * 1024), staticCacheEntries(512),
+	  clientHeaderTimeout(30000), clientBodyTimeout(30000),
+	  keepaliveTimeout(30000), sendTimeout(30000), cgiTimeout(30000) {
+}
+
+void GlobalConfig::setEventEngine(const std::string& value) {
+	if (value != "io_uring" && value != "epoll" && value != "poll")
+		throw std::runtime_error("Error: event_engine must be 'io_uring', 'epoll' or 'poll'.");
+	eventEngine = value;
+}
+
+void GlobalConfig::setWorkerProcesses(const std::string& value) {
+	if (value == "auto") {
+		workerProcesses = 0;
+		return;
+	}
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count == 0 || count > 512)
+		throw std::runtime_error("Error: worker_processes must be 'auto' or a number between 1 and 512.");
+	workerProcesses = count;
+}
+
+void GlobalConfig::setWorkerCpuAffinity(const std::string& value) {
+	if (value != "auto" && value != "off")
+		throw std::runtime_error("Error: worker_cpu_affinity must be 'auto' or 'off'.");
+	workerCpuAffinity = (value == "auto");
+}
+
+void GlobalConfig::setWorkerThreads(const std::string& value) {
+	if (value == "auto") {
+		workerThreads = 0;
+		return;
+	}
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count == 0 || count > 512)
+		throw std::runtime_error("Error: worker_threads must be 'auto' or a number between 1 and 512.");
+	workerThreads = count;
+}
+
+void GlobalConfig::setThreadBalance(const std::string& value) {
+	if (value != "round_robin" && value != "least_conn")
+		throw std::runtime_error("Error: thread_balance must be 'round_robin' or 'least_conn'.");
+	threadBalance = value;
+}
+
+void GlobalConfig::setConnectionPoolSize(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count > 65536)
+		throw std::runtime_error("Error: connection_pool_size must be a number between 0 and 65536.");
+	connectionPoolSize = count;
+}
+
+void GlobalConfig::setWorkerConnections(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof())
+		throw std::runtime_error("Error: worker_connections must be a number (0 = unlimited).");
+	workerConnections = count;
+}
+
+void GlobalConfig::setLimitConnPerIp(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof())
+		throw std::runtime_error("Error: limit_conn_per_ip must be a number (0 = unlimited).");
+	limitConnPerIp = count;
+}
+
+// Dígitos con una unidad k o m opcional al final
+static bool isSize(const std::string& value) {
+	size_t unit = value.find_first_not_of("0123456789");
+	return !value.empty() && unit != 0 && (unit == std::string::npos
+		|| (unit == value.size() - 1 && std::strchr("kKmM", value[unit])));
+}
+
+void GlobalConfig::setClientBodyBufferSize(const std::string& value) {
+	if (!isSize(value))
+		throw std::runtime_error("Error: client_body_buffer_size must be a size (e.g. 16k, 1m).");
+	clientBodyBufferSize = Utils::parseSize(value);
+}
+
+void GlobalConfig::setClientBodyTempPath(const std::string& value) {
+	if (!Utils::isDirectory(value))
+		throw std::runtime_error("Error: client_body_temp_path must be an existing directory: " + value);
+	clientBodyTempPath = value;
+}
+
+void GlobalConfig::setPipelineDepth(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count == 0 || count > 1024)
+		throw std::runtime_error("Error: pipeline_depth must be a number between 1 and 1024.");
+	pipelineDepth = count;
+}
+
+void GlobalConfig::setClientMaxRequestLine(const std::string& value) {
+	if (!isSize(value) || Utils::parseSize(value) == 0)
+		throw std::runtime_error("Error: client_max_request_line must be a size (e.g. 8k).");
+	clientMaxRequestLine = Utils::parseSize(value);
+}
+
+void GlobalConfig::setClientMaxHeaderSize(const std::string& value) {
+	size_t size = isSize(value) ? Utils::parseSize(value) : 0;
+	if (size == 0 || size > 512 * 1024)
+		throw std::runtime_error("Error: client_max_header_size must be a size up to 512k.");
+	clientMaxHeaderSize = size;
+}
+
+void GlobalConfig::setClientMaxHeaderCount(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count == 0 || count > 10000)
+		throw std::runtime_error("Error: client_max_header_count must be a number between 1 and 10000.");
+	clientMaxHeaderCount = count;
+}
+
+void GlobalConfig::setOpenFileCache(const std::string& value) {
+	size_t count = 0;
+	std::istringstream iss(value);
+	if (!(iss >> count) || !iss.eof() || count > 1000000)
+		throw std::runtime_error("Error: open_file_cache must be a number between 0 and 1000000.");
+	openFileCache = count;
+}
+
+void GlobalConfig::setOpenFileCacheEvents(const std::string& value) {
+	if (value != "on" && value != "off")
+		throw std::runtime_error("Error: open_file_cache_events must be 'on' or 'off'.");
+	openFileCacheEvents = (value == "on");
+}
+
+void GlobalConfig::setStaticCache(const std::string& value, const std::vector<std::string>& params) {
+	if (value == "off" && params.empty()) {
+		staticCacheSize = 0;
+		return;
+	}
+	if (!isSize(value))
+		throw std::runtime_error("Error: static_cache must be 'off' or a size (e.g. 8m).");
+	staticCacheSize = Utils::parseSize(value);
+	
+	for (size_t i = 0; i < params.size(); ++i) {
+		size_t eq = params[i].find('=');
+		std::string name = params[i].substr(0, eq);
+		std::string param = eq == std::string::npos ? "" : params[i].substr(eq + 1);
+		if (name == "max_file") {
+			if (!isSize(param))
+				throw std::runtime_error("Error: static_cache max_file must be a size (e.g. 64k).");
+			staticCacheMaxFile = Utils::parseSize(param);
+		} else if (name == "entries") {
+			size_t count = 0;
+			std::istringstream iss(param);
+			if (!(iss >> count) || !iss.eof() || count == 0 || count > 1000000)
+				throw std::runtime_error("Error: static_cache entries must be a number between 1 and 1000000.");
+			staticCacheEntries = count;
+		} else {
+			throw std::runtime_error("Error: unknown static_cache parameter: " + params[i]);
+		}
+	}
+}
+
+static size_t onlineCpus() {
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return cpus > 0 ? static_cast<size_t>(cpus) : 1;
+}
+
+size_t GlobalConfig::resolveWorkerProcesses() const {
+	return workerProcesses > 0 ? workerProcesses : onlineCpus();
+}
+
+size_t GlobalConfig::resolveWorkerThreads() const {
+	return workerThreads > 0 ? workerThreads : onlineCpus();
+}
+
+size_t GlobalConfig::parseDuration(const std::string& directive, const std::string& value) {
+	std::istringstream iss(value);
+	size_t amount = 0;
+	std::string unit;
+	if (!(iss >> amount))
+		throw std::runtime_error("Error: invalid time value for " + directive + ": " + value);
+	iss >> unit;
+
+	if (unit.empty() || unit == "s")
+		return amount * 1000;
+	if (unit == "ms")
+		return amount;
+	if (unit == "m")
+		return amount * 60 * 1000;
+	throw std::runtime_error("Error: invalid time unit for " + directive + ": " + value);
+}
@@ -0,0 +1,93 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HandoffQueue.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:31:08 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:31:08 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "HandoffQueue.hpp"
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdexcept>
+#ifdef __linux__
+# include <sys/eventfd.h>
+#endif
+
+HandoffQueue::HandoffQueue(size_t capacity) : _head(0), _tail(0) {
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+	_slots.resize(size);
+	_mask = size - 1;
+
+#ifdef __linux__
+	_wakeupFds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	_wakeupFds[1] = _wakeupFds[0];
+	if (_wakeupFds[0] < 0)
+		throw std::runtime_error("Error: eventfd failed");
+#else
+	if (pipe(_wakeupFds) < 0)
+		throw std::runtime_error("Error: pipe failed");
+	for (int i = 0; i < 2; ++i) {
+		fcntl(_wakeupFds[i], F_SETFL, fcntl(_wakeupFds[i], F_GETFL, 0) | O_NONBLOCK);
+		fcntl(_wakeupFds[i], F_SETFD, FD_CLOEXEC);
+	}
+#endif
+}
+
+HandoffQueue::~HandoffQueue() {
+	AcceptedClient client;
+	while (pop(client))
+		close(client.fd);
+	close(_wakeupFds[0]);
+	if (_wakeupFds[1] != _wakeupFds[0])
+		close(_wakeupFds[1]);
+}
+
+bool HandoffQueue::push(const AcceptedClient& client) {
+	size_t tail = _tail;
+	size_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+	if (tail - head > _mask)
+		return false; // llena
+
+	_slots[tail & _mask] = client;
+	__atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+
+	uint64_t one = 1;
+	ssize_t ret = write(_wakeupFds[1], &one, _wakeupFds[0] == _wakeupFds[1] ? sizeof(one) : 1);
+	(void)ret; // si el contador/pipe está lleno el consumidor ya tiene aviso pendiente
+	return true;
+}
+
+bool HandoffQueue::pop(AcceptedClient& client) {
+	size_t head = _head;
+	size_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+	if (head == tail)
+		return false;
+
+	client = _slots[head & _mask];
+	__atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+size_t HandoffQueue::size() const {
+	size_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+	size_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+	return tail - head;
+}
+
+int HandoffQueue::getWakeupFd() const {
+	return _wakeupFds[0];
+}
+
+void HandoffQueue::drainWakeup() {
+	char buffer[64];
+	while (read(_wakeupFds[0], buffer, sizeof(buffer)) > 0) {
+	}
+}
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HttpHeaders.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 16:03:27 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 16:03:27 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "HttpHeaders.hpp"
+#include <cstring>
+#include <strings.h>
+
+namespace {
+
+const char* const NAMES[HEADER_COUNT] = {
+	"Server",
+	"Date",
+	"Content-Type",
+	"Content-Length",
+	"Content-Range",
+	"Accept-Ranges",
+	"Last-Modified",
+	"ETag",
+	"Cache-Control",
+	"Location",
+	"Connection",
+	"Transfer-Encoding",
+	"Host",
+	"Expect",
+	"If-None-Match",
+	"If-Modified-Since",
+	"If-Range",
+	"Range",
+	"Accept",
+	"Accept-Encoding",
+	"Authorization",
+	"Cookie",
+	"Referer",
+	"User-Agent"
+};
+
+// Tabla abierta con sondeo lineal; con 24 nombres en 64 huecos casi todas
+// las búsquedas aciertan a la primera
+const size_t TABLE_SIZE = 64;
+const unsigned char EMPTY_SLOT = 0xff;
+
+unsigned char g_table[TABLE_SIZE];
+size_t g_lengths[HEADER_COUNT];
+
+// FNV-1a sobre el nombre en minúsculas. '| 0x20' sólo pasa a minúscula
+// las letras, pero los demás tchar se transforman igual en los dos lados
+// y la comparación final la hace strncasecmp
+size_t hashName(const char* name, size_t len) {
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < len; ++i) {
+		hash ^= static_cast<unsigned char>(name[i]) | 0x20;
+		hash *= 16777619u;
+	}
+	return hash & (TABLE_SIZE - 1);
+}
+
+bool buildTable() {
+	std::memset(g_table, EMPTY_SLOT, sizeof(g_table));
+	for (int id = 0; id < HEADER_COUNT; ++id) {
+		g_lengths[id] = std::strlen(NAMES[id]);
+		size_t slot = hashName(NAMES[id], g_lengths[id]);
+		while (g_table[slot] != EMPTY_SLOT)
+			slot = (slot + 1) & (TABLE_SIZE - 1);
+		g_table[slot] = static_cast<unsigned char>(id);
+	}
+	return true;
+}
+
+const bool g_built = buildTable();
+
+}
+
+namespace HttpHeaders {
+
+HeaderId lookup(const char* name, size_t len) {
+	size_t slot = hashName(name, len);
+	while (g_table[slot] != EMPTY_SLOT) {
+		unsigned char id = g_table[slot];
+		if (g_lengths[id] == len && strncasecmp(NAMES[id], name, len) == 0)
+			return static_cast<HeaderId>(id);
+		slot = (slot + 1) & (TABLE_SIZE - 1);
+	}
+	return HEADER_UNKNOWN;
+}
+
+const char* name(HeaderId id) {
+	return id < HEADER_COUNT ? NAMES[id] : "";
+}
+
+}
@@ -0,0 +1,232 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HttpScan.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:05:10 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:05:10 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "HttpScan.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HTTP_SCAN_X86 1
+# include <immintrin.h>
+#endif
+
+namespace {
+
+const unsigned char CLASS_CTL = 1;		// byte de control: fin de línea o inválido
+const unsigned char CLASS_TOKEN = 2;	// tchar
+
+const unsigned char g_class[256] = {
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,	// 0x00
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 0x10
+	0, 2, 0, 2, 2, 2, 2, 2, 0, 0, 2, 2, 0, 2, 2, 0,	// 0x20
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0,	// 0x30
+	0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,	// 0x40
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 2, 2,	// 0x50
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,	// 0x60
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 2, 0, 2, 1,	// 0x70
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0x80
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0x90
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xa0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xb0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xc0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xd0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xe0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xf0
+};
+
+const char* findControlScalar(const char* p, const char* end) {
+	while (p < end && !(g_class[static_cast<unsigned char>(*p)] & CLASS_CTL))
+		++p;
+	return p;
+}
+
+const char* findNonTokenScalar(const char* p, const char* end) {
+	while (p < end && (g_class[static_cast<unsigned char>(*p)] & CLASS_TOKEN))
+		++p;
+	return p;
+}
+
+#ifdef HTTP_SCAN_X86
+
+// Los vectores marcan candidatos y la tabla decide: en findNonToken sólo
+// letras, dígitos y '-' se descartan en bloque, el resto de tchar (que casi
+// nunca aparece en nombres de header) se confirma byte a byte.
+
+__attribute__((target("sse2")))
+const char* findControlSse2(const char* p, const char* end) {
+	const __m128i limit = _mm_set1_epi8(0x1f);
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i del = _mm_set1_epi8(0x7f);
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, limit), v);
+		ctl = _mm_andnot_si128(_mm_cmpeq_epi8(v, tab), ctl);
+		ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, del));
+		unsigned int mask = _mm_movemask_epi8(ctl);
+		if (mask)
+			return p + __builtin_ctz(mask);
+		p += 16;
+	}
+	return findControlScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char* findNonTokenSse2(const char* p, const char* end) {
+	const __m128i lowerBit = _mm_set1_epi8(0x20);
+	const __m128i letterA = _mm_set1_epi8('a');
+	const __m128i letterSpan = _mm_set1_epi8('z' - 'a');
+	const __m128i digit0 = _mm_set1_epi8('0');
+	const __m128i digitSpan = _mm_set1_epi8(9);
+	const __m128i dash = _mm_set1_epi8('-');
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(v, lowerBit), letterA);
+		__m128i digit = _mm_sub_epi8(v, digit0);
+		__m128i ok = _mm_cmpeq_epi8(_mm_min_epu8(letter, letterSpan), letter);
+		ok = _mm_or_si128(ok, _mm_cmpeq_epi8(_mm_min_epu8(digit, digitSpan), digit));
+		ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, dash));
+		unsigned int mask = ~_mm_movemask_epi8(ok) & 0xffffu;
+		while (mask) {
+			const char* c = p + __builtin_ctz(mask);
+			if (!(g_class[static_cast<unsigned char>(*c)] & CLASS_TOKEN))
+				return c;
+			mask &= mask - 1;
+		}
+		p += 16;
+	}
+	return findNonTokenScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* findControlAvx2(const char* p, const char* end) {
+	const __m256i limit = _mm256_set1_epi8(0x1f);
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i del = _mm256_set1_epi8(0x7f);
+	while (end - p >= 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		__m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, limit), v);
+		ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl);
+		ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+		unsigned int mask = _mm256_movemask_epi8(ctl);
+		if (mask)
+			return p + __builtin_ctz(mask);
+		p += 32;
+	}
+	return findControlSse2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* findNonTokenAvx2(const char* p, const char* end) {
+	const __m256i lowerBit = _mm256_set1_epi8(0x20);
+	const __m256i letterA = _mm256_set1_epi8('a');
+	const __m256i letterSpan = _mm256_set1_epi8('z' - 'a');
+	const __m256i digit0 = _mm256_set1_epi8('0');
+	const __m256i digitSpan = _mm256_set1_epi8(9);
+	const __m256i dash = _mm256_set1_epi8('-');
+	while (end - p >= 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		__m256i letter = _mm256_sub_epi8(_mm256_or_si256(v, lowerBit), letterA);
+		__m256i digit = _mm256_sub_epi8(v, digit0);
+		__m256i ok = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, letterSpan), letter);
+		ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(_mm256_min_epu8(digit, digitSpan), digit));
+		ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, dash));
+		unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(ok));
+		while (mask) {
+			const char* c = p + __builtin_ctz(mask);
+			if (!(g_class[static_cast<unsigned char>(*c)] & CLASS_TOKEN))
+				return c;
+			mask &= mask - 1;
+		}
+		p += 32;
+	}
+	return findNonTokenSse2(p, end);
+}
+
+#endif
+
+typedef const char* (*ScanFunction)(const char*, const char*);
+
+// Inicialización constante: valen antes de que corra ningún constructor
+HttpScan::Kernel g_kernel = HttpScan::SCALAR;
+ScanFunction g_findControl = findControlScalar;
+ScanFunction g_findNonToken = findNonTokenScalar;
+
+bool selectBestKernel() {
+	if (HttpScan::useKernel(HttpScan::AVX2))
+		return true;
+	return HttpScan::useKernel(HttpScan::SSE2);
+}
+
+const bool g_selected = selectBestKernel();
+
+}
+
+namespace HttpScan {
+
+const char* findControl(const char* p, const char* end) {
+	return g_findControl(p, end);
+}
+
+const char* findNonToken(const char* p, const char* end) {
+	return g_findNonToken(p, end);
+}
+
+bool isToken(unsigned char c) {
+	return g_class[c] & CLASS_TOKEN;
+}
+
+bool isControl(unsigned char c) {
+	return g_class[c] & CLASS_CTL;
+}
+
+Kernel activeKernel() {
+	return g_kernel;
+}
+
+const char* kernelName(Kernel kernel) {
+	switch (kernel) {
+		case AVX2: return "avx2";
+		case SSE2: return "sse2";
+		default: return "scalar";
+	}
+}
+
+bool isSupported(Kernel kernel) {
+#ifdef HTTP_SCAN_X86
+	__builtin_cpu_init();
+	if (kernel == AVX2)
+		return __builtin_cpu_supports("avx2");
+	if (kernel == SSE2)
+		return __builtin_cpu_supports("sse2");
+#endif
+	return kernel == SCALAR;
+}
+
+bool useKernel(Kernel kernel) {
+	if (!isSupported(kernel))
+		return false;
+#ifdef HTTP_SCAN_X86
+	if (kernel == AVX2) {
+		g_findControl = findControlAvx2;
+		g_findNonToken = findNonTokenAvx2;
+	} else if (kernel == SSE2) {
+		g_findControl = findControlSse2;
+		g_findNonToken = findNonTokenSse2;
+	}
+#endif
+	if (kernel == SCALAR) {
+		g_findControl = findControlScalar;
+		g_findNonToken = findNonTokenScalar;
+	}
+	g_kernel = kernel;
+	return true;
+}
+
+}
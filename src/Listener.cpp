@@ -22,255 +22,497 @@
 #include <algorithm>
 #include <ctime>
 #include <cerrno>
+#include <fcntl.h>
 
-Listener::Listener(const std::vector<Server*>& servers, const std::vector<ServerConfig>& configs)
-	: _servers(servers), _serverConfigs(&configs) {
-	setupPollFDs();
+// Cada cuánto escribe un bucle del modo multihilo sus estadísticas
+static const time_t STATS_INTERVAL = 60;
+
+// Espera máxima en el poller aunque no haya timers pendientes
+static const int MAX_WAIT_MS = 1000;
+
+// Tiempo total que una conexión descarta datos tras un error antes de
+// cerrarse (LINGERING), lo bastante para que el cliente lea la respuesta
+static const size_t LINGER_TIMEOUT = 2000;
+
+Listener::Listener(const std::vector<Server*>& servers, const std::vector<ServerConfig>& configs,
+				   const GlobalConfig& global)
+	: _poller(Poller::create(global.eventEngine)), _servers(servers), _serverConfigs(&configs),
+	  _global(&global), _pool(global.connectionPoolSize), _dispatcher(NULL), _limiter(NULL),
+	  _acceptPaused(false), _spareFd(-1), _inbox(NULL), _loopId(0), _activeConnections(0), _acceptedTotal(0),
+	  _nextStatsLog(time(NULL) + STATS_INTERVAL) {
+	std::cout << "webserv: using " << _poller->getName() << " event engine" << std::endl;
+	registerListeningSockets();
+	_files.configure(global.openFileCache, global.openFileCacheValid, global.openFileCacheEvents);
+	setInterest(_files.getEventFd(), FD_FILE_EVENTS, NULL, Poller::EVENT_READ);
+	_statics.configure(global.staticCacheSize, global.staticCacheMaxFile, global.staticCacheEntries);
+	if (!_acceptBatch.empty())
+		_spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
 }
 
 Listener::~Listener() {
+	cleanupConnections();
 	for (size_t i = 0; i < _connections.size(); ++i) {
 		delete _connections[i];
 	}
+	delete _poller;
+	if (_spareFd >= 0)
+		close(_spareFd);
 }
 
-void Listener::setupPollFDs() {
-	_pollfds.clear();
+void Listener::registerListeningSockets() {
 	for (size_t i = 0; i < _servers.size(); ++i) {
 		const std::vector<int>& sockets = _servers[i]->getSockets();
+		const std::vector<size_t>& batches = _servers[i]->getAcceptBatches();
 		for (size_t j = 0; j < sockets.size(); ++j) {
-			pollfd pfd;
-			pfd.fd = sockets[j];
-			pfd.events = POLLIN;
-			pfd.revents = 0;
-			_pollfds.push_back(pfd);
+			// Varios Server pueden compartir el mismo socket de escucha:
+			// se queda el accept_batch más alto
+			setInterest(sockets[j], FD_LISTEN, NULL, Poller::EVENT_READ);
+			size_t& batch = _acceptBatch[sockets[j]];
+			batch = std::max(batch, batches[j]);
+		}
+	}
+}
+
+void Listener::setDispatcher(ConnectionDispatcher* dispatcher) {
+	_dispatcher = dispatcher;
+}
+
+void Listener::setLimiter(ConnectionLimiter* limiter) {
+	_limiter = limiter;
+}
+
+void Listener::attachInbox(HandoffQueue* inbox, size_t loopId) {
+	_inbox = inbox;
+	_loopId = loopId;
+	setInterest(inbox->getWakeupFd(), FD_WAKEUP, NULL, Poller::EVENT_READ);
+}
+
+size_t Listener::getActiveConnections() const {
+	return __atomic_load_n(&_activeConnections, __ATOMIC_RELAXED);
+}
+
+// Registra el fd en la tabla y sólo llama al poller si cambia lo que se vigila
+void Listener::setInterest(int fd, FdRole role, ClientConnection* conn, int events) {
+	if (fd < 0) return;
+	
+	FdEntry& entry = _fds.at(fd);
+	entry.role = role;
+	entry.conn = conn;
+	if (!entry.registered) {
+		if (_poller->add(fd, events)) {
+			entry.registered = true;
+			entry.events = events;
 		}
+	} else if (entry.events != events) {
+		if (_poller->modify(fd, events))
+			entry.events = events;
+	}
+}
+
+// Recalcula el interés de una conexión según su ConnectionState
+void Listener::updateInterest(ClientConnection* conn, bool activity) {
+	if (conn->shouldClose()) {
+		retireConnection(conn);
+		return;
+	}
+	refreshTimer(conn, activity);
+	
+	if (conn->isCGIActive()) {
+		// Mientras corre el CGI sólo interesan sus pipes; el socket queda
+		// registrado sin eventos para enterarnos de errores/hangups
+		setInterest(conn->getCGIWriteFd(), FD_CGI_IN, conn, Poller::EVENT_WRITE);
+		setInterest(conn->getCGIReadFd(), FD_CGI_OUT, conn, Poller::EVENT_READ);
+		setInterest(conn->getFd(), FD_CLIENT, conn, 0);
+	} else if (conn->getState() == WRITING_RESPONSE) {
+		setInterest(conn->getFd(), FD_CLIENT, conn, Poller::EVENT_WRITE);
+	} else {
+		setInterest(conn->getFd(), FD_CLIENT, conn, Poller::EVENT_READ);
+	}
+}
+
+size_t Listener::timeoutFor(TimeoutPhase phase) const {
+	switch (phase) {
+		case TIMEOUT_HEADER: return _global->clientHeaderTimeout;
+		case TIMEOUT_BODY: return _global->clientBodyTimeout;
+		case TIMEOUT_KEEPALIVE: return _global->keepaliveTimeout;
+		case TIMEOUT_SEND: return _global->sendTimeout;
+		case TIMEOUT_CGI: return _global->cgiTimeout;
+		case TIMEOUT_LINGER: return LINGER_TIMEOUT;
+	}
+	return _global->clientHeaderTimeout;
+}
+
+// Reprograma el timer sólo al cambiar de fase, o en cada avance si la fase
+// mide el tiempo entre lecturas/escrituras (body y envío). Headers, CGI y
+// keep-alive cuentan desde que empiezan: leer un byte cada poco no los alarga.
+void Listener::refreshTimer(ClientConnection* conn, bool activity) {
+	TimeoutPhase phase = conn->getTimeoutPhase();
+	TimerNode& timer = conn->getTimer();
+	
+	bool rearm = !timer.isPending() || timer.tag != phase;
+	if (activity && (phase == TIMEOUT_BODY || phase == TIMEOUT_SEND)) {
+		rearm = true;
+	}
+	if (rearm) {
+		timer.tag = phase;
+		_timers.schedule(timer, TimerWheel::nowMs() + timeoutFor(phase));
 	}
 }
 
+void Listener::onDescriptorClosing(ClientConnection* /*conn*/, int fd) {
+	FdEntry& entry = _fds.at(fd);
+	if (entry.registered)
+		_poller->remove(fd);
+	_fds.release(fd);
+	_fds.markStale(fd);
+}
+
 void Listener::run() {
 	while (true) {
-		_pollfds.clear();
-		
-		// Add listening sockets
-		for (size_t i = 0; i < _servers.size(); ++i) {
-			const std::vector<int>& sockets = _servers[i]->getSockets();
-			for (size_t j = 0; j < sockets.size(); ++j) {
-				pollfd pfd;
-				pfd.fd = sockets[j];
-				pfd.events = POLLIN;
-				pfd.revents = 0;
-				_pollfds.push_back(pfd);
-			}
+		// Dormir como mucho hasta el próximo timer que pueda vencer
+		int timeout = _timers.nextTimeout(TimerWheel::nowMs());
+		if (timeout < 0 || timeout > MAX_WAIT_MS) {
+			timeout = MAX_WAIT_MS;
 		}
 		
-		// Add client connections (monitor read and write at the same time)
-		for (size_t i = 0; i < _connections.size(); ++i) {
-			if (!_connections[i]->shouldClose()) {
-				// Si hay CGI activo, monitorear sus pipes
-				if (_connections[i]->isCGIActive()) {
-					// Pipe para escribir al CGI
-					int cgiWriteFd = _connections[i]->getCGIWriteFd();
-					if (cgiWriteFd >= 0) {
-						pollfd pfd;
-						pfd.fd = cgiWriteFd;
-						pfd.events = POLLOUT;
-						pfd.revents = 0;
-						_pollfds.push_back(pfd);
-					}
-					// Pipe para leer del CGI
-					int cgiReadFd = _connections[i]->getCGIReadFd();
-					if (cgiReadFd >= 0) {
-						pollfd pfd;
-						pfd.fd = cgiReadFd;
-						pfd.events = POLLIN;
-						pfd.revents = 0;
-						_pollfds.push_back(pfd);
-					}
-				} else {
-					// Conexión normal de cliente
-					pollfd pfd;
-					pfd.fd = _connections[i]->getFd();
-					// La scale exige vigilar lectura y escritura simultáneamente
-					pfd.events = POLLIN | POLLOUT;
-					pfd.revents = 0;
-					_pollfds.push_back(pfd);
-				}
-			}
-		}
-		
-		if (_pollfds.empty()) {
-			checkTimeouts();
-			continue;
+		if (_acceptPaused) {
+			resumeAcceptIfPossible();
 		}
 		
-		int ret = poll(&_pollfds[0], _pollfds.size(), 1000); // 1 second timeout
+		int ret = _poller->wait(_events, timeout);
 		if (ret < 0) {
-			perror("poll");
+			perror(_poller->getName());
 			break;
 		}
 		
-		if (ret == 0) {
-			// Timeout - check for timed out connections
-			checkTimeouts();
-			continue;
+		// Los fds cerrados en la iteración anterior ya salieron del poller
+		_fds.clearStale();
+		Response::refreshDate(time(NULL));
+		if (ret > 0) {
+			dispatchEvents();
 		}
 		
-		std::vector<ClientConnection*> newConnections;
+		// Los timers se revisan en cada vuelta, no sólo cuando wait() vence:
+		// con tráfico constante wait() casi nunca llega al timeout
+		expireTimers();
 		
-		// First, handle listening sockets (new connections)
-		for (size_t i = 0; i < _pollfds.size(); ++i) {
-			if (_pollfds[i].revents == 0) continue;
-			if (_pollfds[i].fd < 0) continue;
-			
-			if (isListeningSocket(_pollfds[i].fd)) {
-				if (_pollfds[i].revents & POLLIN) {
-					handleNewConnection(_pollfds[i].fd, newConnections);
-				}
-			}
-		}
+		// Clean up closed connections
+		cleanupConnections();
 		
-		// Add new connections before handling client connections
-		for (size_t i = 0; i < newConnections.size(); ++i) {
-			_connections.push_back(newConnections[i]);
+		// El aceptador del modo multihilo no tiene conexiones propias
+		if (!_dispatcher && time(NULL) >= _nextStatsLog) {
+			logStats();
 		}
-		
-		// Then handle existing client connections and CGI pipes
-		for (size_t i = 0; i < _pollfds.size(); ++i) {
-			if (_pollfds[i].revents == 0) continue;
-			if (_pollfds[i].fd < 0) continue;
-			
-			if (!isListeningSocket(_pollfds[i].fd)) {
-				// Verificar si es un pipe de CGI
-				ClientConnection* cgiConn = findConnectionByCGIFd(_pollfds[i].fd);
-				if (cgiConn) {
-					handleCGIPipe(cgiConn, _pollfds[i].fd, _pollfds[i].revents);
-				} else {
-					// Es una conexión normal de cliente
-					handleClientConnection(_pollfds[i].fd, _pollfds[i].revents);
-				}
+	}
+}
+
+void Listener::dispatchEvents() {
+	std::vector<ClientConnection*> newConnections;
+	
+	// First, handle listening sockets (new connections)
+	for (size_t i = 0; i < _events.size(); ++i) {
+		if (isListeningSocket(_events[i].fd)) {
+			if (_events[i].events & Poller::EVENT_READ) {
+				handleNewConnection(_events[i].fd, newConnections);
 			}
 		}
+	}
+	
+	// Add new connections before handling client connections
+	for (size_t i = 0; i < newConnections.size(); ++i) {
+		adoptConnection(newConnections[i]);
+	}
+	
+	// Then handle existing client connections and CGI pipes
+	for (size_t i = 0; i < _events.size(); ++i) {
+		const FdEntry* entry = _fds.find(_events[i].fd);
+		if (!entry) continue; // cerrado durante este lote
 		
-		// Clean up closed connections
-		cleanupConnections();
+		if (entry->role == FD_CLIENT) {
+			handleClientConnection(entry->conn, _events[i].events);
+		} else if (entry->role == FD_CGI_IN || entry->role == FD_CGI_OUT) {
+			handleCGIPipe(entry->conn, entry->role, _events[i].events);
+		} else if (entry->role == FD_WAKEUP) {
+			drainInbox();
+		} else if (entry->role == FD_FILE_EVENTS) {
+			_files.processEvents();
+		}
+	}
+}
+
+void Listener::adoptConnection(ClientConnection* conn) {
+	conn->setObserver(this);
+	conn->setBufferPool(&_buffers);
+	conn->setFileCache(&_files);
+	conn->setStaticCache(&_statics);
+	conn->setServers(_serverConfigs);
+	conn->setBodyBuffering(_global->clientBodyBufferSize, _global->clientBodyTempPath);
+	conn->setPipelineDepth(_global->pipelineDepth);
+	conn->setHeaderLimits(_global->clientMaxRequestLine, _global->clientMaxHeaderSize,
+						  _global->clientMaxHeaderCount);
+	conn->setSlot(_connections.size());
+	_connections.push_back(conn);
+	__atomic_add_fetch(&_activeConnections, 1, __ATOMIC_RELAXED);
+	_acceptedTotal++;
+	updateInterest(conn, true);
+}
+
+// Clientes que el hilo aceptador ha dejado en la cola de este bucle
+void Listener::drainInbox() {
+	_inbox->drainWakeup();
+	AcceptedClient client;
+	while (_inbox->pop(client)) {
+		ClientConnection* conn = _pool.acquire(client.fd);
+		conn->setPeerAddress(client.addr);
+		adoptConnection(conn);
 	}
 }
 
+void Listener::logStats() {
+	std::cout << "webserv: loop " << _loopId << ": "
+			  << getActiveConnections() << " active connections, "
+			  << _acceptedTotal << " accepted; pool "
+			  << _pool.getHits() << " hits, " << _pool.getMisses() << " misses, "
+			  << _pool.getSize() << " idle (" << _pool.getResidentBytes() / 1024
+			  << " KB); files " << _files.getHits() << " hits, " << _files.getMisses()
+			  << " misses, " << _files.getSize() << " cached; static "
+			  << _statics.getHits() << " hits, " << _statics.getMisses() << " misses, "
+			  << _statics.getEvictions() << " evictions, " << _statics.getSize() << " files ("
+			  << _statics.getBytes() / 1024 << " KB)" << std::endl;
+	_nextStatsLog = time(NULL) + STATS_INTERVAL;
+}
+
 bool Listener::isListeningSocket(int fd) const {
-	for (size_t i = 0; i < _servers.size(); ++i) {
-		const std::vector<int>& sockets = _servers[i]->getSockets();
-		for (size_t j = 0; j < sockets.size(); ++j) {
-			if (sockets[j] == fd)
-				return true;
-		}
+	const FdEntry* entry = _fds.find(fd);
+	return entry && entry->role == FD_LISTEN;
+}
+
+// Respuesta fija para los clientes que se rechazan nada más aceptarlos
+static const char SERVICE_UNAVAILABLE[] =
+	"HTTP/1.1 503 Service Unavailable\r\n"
+	"Content-Type: text/plain\r\n"
+	"Content-Length: 24\r\n"
+	"Retry-After: 1\r\n"
+	"Connection: close\r\n"
+	"\r\n"
+	"503 Service Unavailable\n";
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+// Un único send sin esperar: si no cabe entero, el cliente sólo ve el cierre
+static void rejectClient(int clientFd) {
+	ssize_t ret = send(clientFd, SERVICE_UNAVAILABLE, sizeof(SERVICE_UNAVAILABLE) - 1,
+					   MSG_DONTWAIT | MSG_NOSIGNAL);
+	(void)ret;
+	close(clientFd);
+}
+
+// Devuelve el cliente ya no bloqueante y con close-on-exec (que no se
+// herede en los CGI), o -1 si no queda ninguno en la cola
+static int acceptClient(int listenFd, uint32_t& addr) {
+	struct sockaddr_in clientAddr;
+	socklen_t addrLen = sizeof(clientAddr);
+	std::memset(&clientAddr, 0, sizeof(clientAddr));
+#ifdef __linux__
+	int clientFd = accept4(listenFd, (struct sockaddr*)&clientAddr, &addrLen,
+						   SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+	int clientFd = accept(listenFd, (struct sockaddr*)&clientAddr, &addrLen);
+	if (clientFd >= 0) {
+		fcntl(clientFd, F_SETFL, fcntl(clientFd, F_GETFL, 0) | O_NONBLOCK);
+		fcntl(clientFd, F_SETFD, FD_CLOEXEC);
 	}
-	return false;
+#endif
+	addr = clientAddr.sin_addr.s_addr;
+	return clientFd;
 }
 
+// Vacía la cola de aceptación hasta que accept falle o se llegue al
+// accept_batch del socket, para no dejar que la cola se desborde con
+// ráfagas de conexiones
 void Listener::handleNewConnection(int fd, std::vector<ClientConnection*>& newConnections) {
 	if (!isListeningSocket(fd)) {
 		return; // Safety check
 	}
 	
-	struct sockaddr_in clientAddr;
-	socklen_t addrLen = sizeof(clientAddr);
-	int clientFd = accept(fd, (struct sockaddr*)&clientAddr, &addrLen);
-	
-	if (clientFd < 0) {
-		// accept failed: could be EAGAIN/EWOULDBLOCK (normal for non-blocking)
-		// or actual error - don't check errno, just return and retry on next poll
+	size_t batch = _acceptBatch[fd];
+	for (size_t accepted = 0; accepted < batch; ++accepted) {
+		if (_limiter && _limiter->isFull()) {
+			// worker_connections: los nuevos esperan en el backlog del kernel
+			pauseAccept();
+			return;
+		}
+		
+		AcceptedClient client;
+		client.fd = acceptClient(fd, client.addr);
+		if (client.fd < 0) {
+			// Normalmente EAGAIN (cola vacía); sólo importa quedarse sin fds,
+			// porque entonces el socket sigue listo y el bucle giraría en vacío
+			if (errno == EMFILE || errno == ENFILE) {
+				shedWithSpareFd(fd);
+			}
+			return;
+		}
+		
+		if (_limiter && _limiter->admit(client.addr) != ConnectionLimiter::ADMIT) {
+			// limit_conn_per_ip (o se llenó justo ahora)
+			rejectClient(client.fd);
+			continue;
+		}
+		
+		if (_dispatcher) {
+			// Modo multihilo: el cliente vivirá en el bucle que elija el reparto
+			if (!_dispatcher->dispatch(client)) {
+				if (_limiter)
+					_limiter->release(client.addr);
+				rejectClient(client.fd);
+			}
+			continue;
+		}
+		
+		ClientConnection* conn = _pool.acquire(client.fd);
+		conn->setPeerAddress(client.addr);
+		newConnections.push_back(conn);
+	}
+}
+
+// Suelta el fd de reserva para poder aceptar al primer cliente de la cola y
+// despacharlo con un 503; si no hay reserva, deja de aceptar un rato
+void Listener::shedWithSpareFd(int listenFd) {
+	if (_spareFd < 0) {
+		pauseAccept();
 		return;
 	}
+	close(_spareFd);
+	uint32_t addr;
+	int clientFd = acceptClient(listenFd, addr);
+	if (clientFd >= 0) {
+		rejectClient(clientFd);
+	}
+	_spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+void Listener::pauseAccept() {
+	if (_acceptPaused) return;
+	for (std::map<int, size_t>::const_iterator it = _acceptBatch.begin();
+		 it != _acceptBatch.end(); ++it) {
+		setInterest(it->first, FD_LISTEN, NULL, 0);
+	}
+	_acceptPaused = true;
+}
+
+// Se prueba en cada vuelta del bucle: las conexiones se liberan en otros
+// hilos, así que en modo multihilo puede tardar hasta MAX_WAIT_MS
+void Listener::resumeAcceptIfPossible() {
+	if (_spareFd < 0) {
+		_spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+		if (_spareFd < 0) return;
+	}
+	if (_limiter && _limiter->isFull()) return;
 	
-	ClientConnection* conn = new ClientConnection(clientFd);
-	newConnections.push_back(conn);
+	for (std::map<int, size_t>::const_iterator it = _acceptBatch.begin();
+		 it != _acceptBatch.end(); ++it) {
+		setInterest(it->first, FD_LISTEN, NULL, Poller::EVENT_READ);
+	}
+	_acceptPaused = false;
 }
 
-void Listener::handleClientConnection(int fd, short revents) {
-	ClientConnection* conn = findConnection(fd);
-	if (!conn) return;
+void Listener::handleClientConnection(ClientConnection* conn, int events) {
+	if (!conn || conn->shouldClose()) return;
 	
-	if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+	if (events & Poller::EVENT_ERROR) {
 		// Error en el socket - cerrar y marcar para eliminación
 		conn->close(); // close() ahora también setea _shouldClose = true
+		retireConnection(conn);
 		return;
 	}
 	// Solo una operación por cliente por iteración
 	if (conn->getState() == READING_REQUEST) {
-		if (revents & POLLIN) {
+		if (events & Poller::EVENT_READ) {
 			if (conn->readRequest()) {
-				conn->processRequest(*_serverConfigs);
+				conn->serveRequests(*_serverConfigs);
 			}
 		}
 	} else if (conn->getState() == WRITING_RESPONSE) {
-		if (revents & POLLOUT) {
+		if (events & Poller::EVENT_WRITE) {
 			conn->writeResponse();
+			if (conn->getState() == PROCESSING) {
+				// Al liberarse la cola, la siguiente ya estaba en el buffer
+				conn->serveRequests(*_serverConfigs);
+			}
+		}
+	} else if (conn->getState() == LINGERING) {
+		if (events & Poller::EVENT_READ) {
+			conn->drainLinger();
 		}
 	}
 	// Estados WRITING_TO_CGI y READING_FROM_CGI se manejan en handleCGIPipe
+	updateInterest(conn, true);
 }
 
-void Listener::handleCGIPipe(ClientConnection* conn, int fd, short revents) {
-	if (!conn) return;
+void Listener::handleCGIPipe(ClientConnection* conn, FdRole role, int events) {
+	if (!conn || conn->shouldClose()) return;
 	
-	if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
-		// Error en el pipe - cerrar conexión
-		conn->close();
-		return;
-	}
-	
-	// Verificar qué pipe es
-	if (fd == conn->getCGIWriteFd()) {
+	if (role == FD_CGI_IN) {
+		if (events & Poller::EVENT_ERROR) {
+			// El CGI cerró su stdin - cerrar conexión
+			conn->close();
+			retireConnection(conn);
+			return;
+		}
 		// Pipe para escribir al CGI
-		if (revents & POLLOUT) {
+		if (events & Poller::EVENT_WRITE) {
 			conn->writeToCGI();
 		}
-	} else if (fd == conn->getCGIReadFd()) {
-		// Pipe para leer del CGI
-		if (revents & POLLIN) {
+	} else {
+		// Pipe para leer del CGI. Un hangup aquí significa que el CGI ha
+		// terminado: read() devuelve lo que quede y después EOF
+		if (events & (Poller::EVENT_READ | Poller::EVENT_ERROR)) {
 			conn->readFromCGI();
 		}
 	}
+	updateInterest(conn, true);
 }
 
-ClientConnection* Listener::findConnection(int fd) {
-	for (size_t i = 0; i < _connections.size(); ++i) {
-		if (_connections[i]->getFd() == fd) {
-			return _connections[i];
-		}
-	}
-	return NULL;
-}
-
-ClientConnection* Listener::findConnectionByCGIFd(int fd) {
-	for (size_t i = 0; i < _connections.size(); ++i) {
-		if (_connections[i]->isCGIActive()) {
-			if (_connections[i]->getCGIWriteFd() == fd || 
-				_connections[i]->getCGIReadFd() == fd) {
-				return _connections[i];
-			}
-		}
-	}
-	return NULL;
+// Saca la conexión del vector en O(1) (el último ocupa su hueco) y la deja
+// pendiente de delete hasta el final de la iteración, por si quedan eventos
+// suyos en el lote actual
+void Listener::retireConnection(ClientConnection* conn) {
+	size_t slot = conn->getSlot();
+	if (slot >= _connections.size() || _connections[slot] != conn)
+		return; // ya retirada
+	
+	ClientConnection* last = _connections.back();
+	_connections[slot] = last;
+	last->setSlot(slot);
+	_connections.pop_back();
+	_timers.cancel(conn->getTimer());
+	_closing.push_back(conn);
+	__atomic_sub_fetch(&_activeConnections, 1, __ATOMIC_RELAXED);
 }
 
 void Listener::cleanupConnections() {
-	for (std::vector<ClientConnection*>::iterator it = _connections.begin();
-		 it != _connections.end();) {
-		if ((*it)->shouldClose()) {
-			delete *it;
-			it = _connections.erase(it);
-		} else {
-			++it;
-		}
+	for (size_t i = 0; i < _closing.size(); ++i) {
+		uint32_t addr = _closing[i]->getPeerAddress();
+		_pool.release(_closing[i]);	// aquí se cierra su socket
+		if (_limiter)
+			_limiter->release(addr);
 	}
+	_closing.clear();
 }
 
-void Listener::checkTimeouts() {
-	for (size_t i = 0; i < _connections.size(); ++i) {
-		if (_connections[i]->isTimeout(30)) { // 30 second timeout
-			_connections[i]->close();
-		}
+void Listener::expireTimers() {
+	_expired.clear();
+	_timers.advance(TimerWheel::nowMs(), _expired);
+	
+	for (size_t i = 0; i < _expired.size(); ++i) {
+		ClientConnection* conn = static_cast<ClientConnection*>(_expired[i]->owner);
+		if (conn->shouldClose()) continue;
+		
+		// 408/504 si hay una petición en curso; si no, cierre directo
+		conn->handleTimeout(static_cast<TimeoutPhase>(_expired[i]->tag));
+		updateInterest(conn, false);
 	}
 }
@@ -0,0 +1,225 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Master.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 13:05:52 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 13:05:52 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Master.hpp"
+#include "Server.hpp"
+#include "Listener.hpp"
+#include "ReactorPool.hpp"
+#include "ConnectionLimiter.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __linux__
+# include <sched.h>
+#endif
+
+// Código de salida de un worker que no pudo arrancar (p.ej. bind fallido):
+// relanzarlo no serviría de nada
+static const int WORKER_STARTUP_FAILED = 2;
+
+static volatile sig_atomic_t g_stopMaster = 0;
+
+static void handleStopSignal(int /*sig*/) {
+	g_stopMaster = 1;
+}
+
+Master::Master(const std::vector<ServerConfig>& configs, const GlobalConfig& global)
+	: _configs(configs), _global(global) {
+	size_t count = _global.resolveWorkerProcesses();
+	_workers.assign(count, -1);
+	_spawnTimes.assign(count, 0);
+}
+
+Master::~Master() {}
+
+int Master::runWorker(const std::vector<ServerConfig>& configs,
+					  const GlobalConfig& global, bool reusePort) {
+	// Un cliente que cierra con respuestas pendientes no debe matar al
+	// worker: writev() no admite MSG_NOSIGNAL, el error llega como EPIPE
+	signal(SIGPIPE, SIG_IGN);
+
+	// Create Server instances
+	std::vector<Server*> servers;
+	try {
+		for (size_t i = 0; i < configs.size(); ++i) {
+			servers.push_back(new Server(configs[i], reusePort));
+		}
+	} catch (...) {
+		for (size_t i = 0; i < servers.size(); ++i) {
+			delete servers[i];
+		}
+		Server::closeAllSockets();
+		throw;
+	}
+
+	// Límites de conexiones de este worker, compartidos por todos sus hilos
+	ConnectionLimiter limiter(global.workerConnections, global.limitConnPerIp);
+
+	// Create Listener and run
+	size_t threads = global.resolveWorkerThreads();
+	if (threads > 1) {
+		// Este hilo sólo acepta; los clientes se reparten entre los bucles
+		ReactorPool pool(configs, global, threads, &limiter);
+		Listener acceptor(servers, configs, global);
+		acceptor.setDispatcher(&pool);
+		acceptor.setLimiter(&limiter);
+		pool.start();
+		acceptor.run();
+	} else {
+		Listener listener(servers, configs, global);
+		listener.setLimiter(&limiter);
+		listener.run();
+	}
+
+	// Cleanup (unreachable in normal operation)
+	for (size_t i = 0; i < servers.size(); ++i) {
+		delete servers[i];
+	}
+	Server::closeAllSockets();
+	return 1;
+}
+
+// Abre y cierra los sockets una vez en el master para que un puerto ocupado
+// o una IP inválida falle antes de lanzar ningún worker
+void Master::validateSockets() {
+	std::vector<Server*> probe;
+	try {
+		for (size_t i = 0; i < _configs.size(); ++i) {
+			probe.push_back(new Server(_configs[i], true));
+		}
+	} catch (...) {
+		for (size_t i = 0; i < probe.size(); ++i) {
+			delete probe[i];
+		}
+		Server::closeAllSockets();
+		throw;
+	}
+	for (size_t i = 0; i < probe.size(); ++i) {
+		delete probe[i];
+	}
+	// El master no acepta conexiones: si conservara sus copias, el kernel
+	// le repartiría clientes que nadie atendería
+	Server::closeAllSockets();
+}
+
+int Master::run() {
+	validateSockets();
+
+	struct sigaction sa;
+	sa.sa_handler = handleStopSignal;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;	// sin SA_RESTART: waitpid debe volver con EINTR
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+
+	std::cout << "webserv: master " << getpid() << " starting "
+			  << _workers.size() << " worker processes" << std::endl;
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		spawnWorker(i);
+	}
+
+	int exitCode = 0;
+	while (!g_stopMaster) {
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		size_t index = 0;
+		while (index < _workers.size() && _workers[index] != pid)
+			++index;
+		if (index == _workers.size()) continue;
+		_workers[index] = -1;
+		if (g_stopMaster) break;
+
+		if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_STARTUP_FAILED) {
+			std::cerr << "webserv: worker " << pid << " failed to start, shutting down" << std::endl;
+			exitCode = 1;
+			break;
+		}
+
+		std::cerr << "webserv: worker " << pid << " exited";
+		if (WIFSIGNALED(status))
+			std::cerr << " (signal " << WTERMSIG(status) << ")";
+		std::cerr << ", respawning" << std::endl;
+
+		// Evitar un bucle de respawn si el worker muere nada más arrancar
+		if (time(NULL) - _spawnTimes[index] < 1)
+			sleep(1);
+		spawnWorker(index);
+	}
+
+	shutdownWorkers();
+	return exitCode;
+}
+
+void Master::spawnWorker(size_t index) {
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return;
+	}
+
+	if (pid == 0) {
+		// Worker: vuelve al comportamiento por defecto ante SIGTERM/SIGINT
+		signal(SIGTERM, SIG_DFL);
+		signal(SIGINT, SIG_DFL);
+		if (_global.workerCpuAffinity)
+			pinToCpu(index);
+
+		int code;
+		try {
+			code = runWorker(_configs, _global, true);
+		} catch (const std::exception& e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+			code = WORKER_STARTUP_FAILED;
+		}
+		std::exit(code);
+	}
+
+	_workers[index] = pid;
+	_spawnTimes[index] = time(NULL);
+}
+
+void Master::shutdownWorkers() {
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (_workers[i] > 0)
+			kill(_workers[i], SIGTERM);
+	}
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (_workers[i] > 0) {
+			waitpid(_workers[i], NULL, 0);
+			_workers[i] = -1;
+		}
+	}
+}
+
+void Master::pinToCpu(size_t index) {
+#ifdef __linux__
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus <= 0)
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(index % cpus, &set);
+	if (sched_setaffinity(0, sizeof(set), &set) < 0)
+		perror("sched_setaffinity");
+#else
+	(void)index;
+#endif
+}
@@ -0,0 +1,371 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   OpenFileCache.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 00:12:40 by luis              #+#    #+#             */
+/*   Updated: 2026/10/17 00:12:40 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "OpenFileCache.hpp"
+#include "TimerWheel.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdio>
+#ifdef __linux__
+# include <sys/inotify.h>
+#endif
+
+namespace {
+
+// Directorios vigilados como mucho por caché. Cada bucle de cada worker
+// tiene su instancia de inotify y todas gastan de fs.inotify.max_user_watches;
+// pasado el tope las entradas nuevas sólo caducan por tiempo
+const size_t WATCH_MAX = 1024;
+
+// La misma ruta escrita con "//" es la misma entrada
+std::string collapseSlashes(const std::string& path) {
+	std::string out;
+	out.reserve(path.size());
+	for (size_t i = 0; i < path.size(); ++i) {
+		if (path[i] != '/' || out.empty() || out[out.size() - 1] != '/') {
+			out += path[i];
+		}
+	}
+	return out;
+}
+
+std::string parentOf(const std::string& path) {
+	size_t slash = path.rfind('/');
+	if (slash == std::string::npos) {
+		return ".";
+	}
+	return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+}
+
+OpenFileCache::OpenFileCache()
+	: _maxEntries(0), _validMs(0), _eventFd(-1), _hits(0), _misses(0) {
+}
+
+OpenFileCache::~OpenFileCache() {
+	clear();
+	release(_uncached.info);
+	if (_eventFd >= 0) {
+		close(_eventFd);
+	}
+}
+
+void OpenFileCache::configure(size_t maxEntries, size_t validMs, bool events) {
+	clear();
+	_maxEntries = maxEntries;
+	_validMs = validMs;
+#ifdef __linux__
+	if (events && maxEntries > 0 && _eventFd < 0) {
+		_eventFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (_eventFd < 0) {
+			// Sin eventos las entradas siguen caducando por tiempo
+			perror("webserv: inotify_init1");
+		}
+	}
+#else
+	(void)events;
+#endif
+}
+
+// Un solo open() para saber si existe y, si es un fichero, dejarlo abierto.
+// O_NONBLOCK para que abrir un FIFO no bloquee el bucle
+void OpenFileCache::load(FileInfo& info, const std::string& path) {
+	release(info);
+	info = FileInfo();
+	int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		info.error = errno;
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		info.error = errno;
+		close(fd);
+		return;
+	}
+	fill(info, st);
+	if (info.isFile()) {
+		info.fd = fd;
+		return;
+	}
+	close(fd);
+}
+
+// Sólo los metadatos, sin abrir nada
+void OpenFileCache::probe(FileInfo& info, const std::string& path) {
+	release(info);
+	info = FileInfo();
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		info.error = errno;
+		return;
+	}
+	fill(info, st);
+}
+
+void OpenFileCache::fill(FileInfo& info, const struct stat& st) {
+	info.error = 0;
+	info.isDirectory = S_ISDIR(st.st_mode);
+	info.size = static_cast<size_t>(st.st_size);
+	info.mtime = st.st_mtime;
+	info.inode = st.st_ino;
+	if (!info.isDirectory && !S_ISREG(st.st_mode)) {
+		// Dispositivos, sockets, FIFOs: no se sirven
+		info.error = EACCES;
+	}
+}
+
+// Entrada caducada: si el stat() dice que es el mismo fichero sin cambios se
+// conserva el descriptor; si no, se vuelve a abrir (o basta con el stat())
+void OpenFileCache::revalidate(FileInfo& info, const std::string& path, bool open) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		release(info);
+		info = FileInfo();
+		info.error = errno;
+		return;
+	}
+	if (info.exists() && info.isDirectory == S_ISDIR(st.st_mode) && info.inode == st.st_ino
+		&& info.mtime == st.st_mtime && info.size == static_cast<size_t>(st.st_size)) {
+		return;
+	}
+	if (open) {
+		load(info, path);
+		return;
+	}
+	release(info);
+	info = FileInfo();
+	fill(info, st);
+}
+
+void OpenFileCache::release(FileInfo& info) {
+	if (info.fd >= 0) {
+		close(info.fd);
+		info.fd = -1;
+	}
+}
+
+const FileInfo& OpenFileCache::lookup(const std::string& path, bool open) {
+	if (path.find("//") != std::string::npos) {
+		return lookup(collapseSlashes(path), open);
+	}
+	if (_maxEntries == 0) {
+		_misses++;
+		if (open) {
+			load(_uncached.info, path);
+		} else {
+			probe(_uncached.info, path);
+		}
+		return _uncached.info;
+	}
+	
+	uint64_t now = TimerWheel::nowMs();
+	EntryIndex::iterator it = _index.find(path);
+	if (it != _index.end()) {
+		// Pasa a ser la más reciente; splice no invalida el iterador
+		_entries.splice(_entries.begin(), _entries, it->second);
+		Entry& entry = *it->second;
+		if (now < entry.validUntil) {
+			_hits++;
+		} else {
+			_misses++;
+			revalidate(entry.info, path, open);
+			entry.validUntil = now + _validMs;
+		}
+		// Guardada con sólo los metadatos y ahora hace falta el descriptor
+		if (open && entry.info.isFile() && entry.info.fd < 0) {
+			load(entry.info, path);
+		}
+		return entry.info;
+	}
+	
+	_misses++;
+	if (_entries.size() >= _maxEntries) {
+		erase(_index.find(_entries.back().path));
+	}
+	_entries.push_front(Entry());
+	Entry& entry = _entries.front();
+	entry.path = path;
+	entry.validUntil = now + _validMs;
+	if (open) {
+		load(entry.info, path);
+	} else {
+		probe(entry.info, path);
+	}
+	_index[path] = _entries.begin();
+	if (_eventFd >= 0) {
+		entry.watched = watchDirectory(path);
+	}
+	return entry.info;
+}
+
+void OpenFileCache::invalidate(const std::string& path) {
+	if (path.find("//") != std::string::npos) {
+		invalidate(collapseSlashes(path));
+		return;
+	}
+	EntryIndex::iterator it = _index.find(path);
+	if (it != _index.end()) {
+		erase(it);
+	}
+}
+
+void OpenFileCache::clear() {
+	for (EntryList::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		release(it->info);
+	}
+	_entries.clear();
+	_index.clear();
+	dropWatches();
+}
+
+void OpenFileCache::erase(EntryIndex::iterator it) {
+	Entry& entry = *it->second;
+	release(entry.info);
+	if (entry.watched) {
+		unwatchDirectory(entry.path);
+	}
+	_entries.erase(it->second);
+	_index.erase(it);
+}
+
+// Todas las rutas que empiezan por 'prefix': en el mapa ordenado van seguidas
+void OpenFileCache::erasePrefix(const std::string& prefix) {
+	EntryIndex::iterator it = _index.lower_bound(prefix);
+	while (it != _index.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+		erase(it++);
+	}
+}
+
+// Se vigila el directorio y no el fichero: así se ven también los ficheros
+// que se crean (entradas negativas) o se reemplazan con rename(). Devuelve
+// true si la entrada cuenta en el watch de su directorio
+bool OpenFileCache::watchDirectory(const std::string& path) {
+#ifdef __linux__
+	std::string dir = parentOf(path);
+	std::map<std::string, DirWatch>::iterator it = _watchedDirs.find(dir);
+	if (it != _watchedDirs.end()) {
+		it->second.entries++;
+		return true;
+	}
+	if (_watchedDirs.size() >= WATCH_MAX) {
+		return false;
+	}
+	int wd = inotify_add_watch(_eventFd, dir.c_str(), IN_ONLYDIR | IN_ATTRIB | IN_MODIFY
+		| IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+	if (wd < 0) {
+		// Directorio inexistente o sin watches libres: caduca por tiempo
+		return false;
+	}
+	_watches[wd] = dir;
+	DirWatch& watch = _watchedDirs[dir];
+	watch.wd = wd;
+	watch.entries = 1;
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+// Con la última entrada del directorio se quita su watch
+void OpenFileCache::unwatchDirectory(const std::string& path) {
+#ifdef __linux__
+	std::map<std::string, DirWatch>::iterator it = _watchedDirs.find(parentOf(path));
+	if (it == _watchedDirs.end() || --it->second.entries > 0) {
+		return;
+	}
+	// El IN_IGNORED que genera llega con un wd que ya no está en _watches
+	inotify_rm_watch(_eventFd, it->second.wd);
+	_watches.erase(it->second.wd);
+	_watchedDirs.erase(it);
+#else
+	(void)path;
+#endif
+}
+
+void OpenFileCache::dropWatches() {
+#ifdef __linux__
+	for (std::map<int, std::string>::iterator it = _watches.begin(); it != _watches.end(); ++it) {
+		inotify_rm_watch(_eventFd, it->first);
+	}
+#endif
+	_watches.clear();
+	_watchedDirs.clear();
+}
+
+void OpenFileCache::processEvents() {
+#ifdef __linux__
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	while (true) {
+		ssize_t bytes = read(_eventFd, buffer, sizeof(buffer));
+		if (bytes <= 0) {
+			return;
+		}
+		const char* p = buffer;
+		while (p < buffer + bytes) {
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+			p += sizeof(struct inotify_event) + event->len;
+			
+			if (event->mask & IN_Q_OVERFLOW) {
+				// Se han perdido eventos: no se sabe qué ha cambiado
+				clear();
+				continue;
+			}
+			std::map<int, std::string>::iterator watch = _watches.find(event->wd);
+			if (watch == _watches.end()) {
+				continue;
+			}
+			// Copia: invalidar puede quitar el watch si era su última entrada
+			std::string dir = watch->second;
+			std::string changed = dir;
+			if (event->len > 0 && event->name[0] != '\0') {
+				if (dir != "/") {
+					changed += '/';
+				}
+				changed += event->name;
+			}
+			// La ruta y, si era un directorio, todo lo que cuelga de ella
+			invalidate(changed);
+			erasePrefix(changed == "/" ? changed : changed + "/");
+			
+			if (event->mask & IN_IGNORED) {
+				// El kernel ha quitado el watch (directorio borrado): lo que
+				// colgaba de él ya se ha descartado arriba
+				_watches.erase(event->wd);
+				std::map<std::string, DirWatch>::iterator it = _watchedDirs.find(dir);
+				if (it != _watchedDirs.end() && it->second.wd == event->wd) {
+					_watchedDirs.erase(it);
+				}
+			}
+		}
+	}
+#endif
+}
+
+int OpenFileCache::getEventFd() const {
+	return _eventFd;
+}
+
+size_t OpenFileCache::getHits() const {
+	return _hits;
+}
+
+size_t OpenFileCache::getMisses() const {
+	return _misses;
+}
+
+size_t OpenFileCache::getSize() const {
+	return _entries.size();
+}
@@ -0,0 +1,96 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   PollPoller.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "PollPoller.hpp"
+#include <cerrno>
+
+PollPoller::PollPoller() {}
+
+PollPoller::~PollPoller() {}
+
+short PollPoller::toPollEvents(int events) {
+	short result = 0;
+	if (events & EVENT_READ)
+		result |= POLLIN;
+	if (events & EVENT_WRITE)
+		result |= POLLOUT;
+	return result;
+}
+
+bool PollPoller::add(int fd, int events) {
+	if (fd < 0)
+		return false;
+	if (static_cast<size_t>(fd) >= _index.size())
+		_index.resize(fd + 1, -1);
+	if (_index[fd] >= 0)
+		return modify(fd, events);
+
+	pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = toPollEvents(events);
+	pfd.revents = 0;
+	_index[fd] = _pollfds.size();
+	_pollfds.push_back(pfd);
+	return true;
+}
+
+bool PollPoller::modify(int fd, int events) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] < 0)
+		return false;
+	_pollfds[_index[fd]].events = toPollEvents(events);
+	return true;
+}
+
+void PollPoller::remove(int fd) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] < 0)
+		return;
+
+	// Mover el último al hueco para no desplazar el vector
+	size_t pos = _index[fd];
+	size_t last = _pollfds.size() - 1;
+	if (pos != last) {
+		_pollfds[pos] = _pollfds[last];
+		_index[_pollfds[pos].fd] = pos;
+	}
+	_pollfds.pop_back();
+	_index[fd] = -1;
+}
+
+int PollPoller::wait(std::vector<Event>& ready, int timeoutMs) {
+	ready.clear();
+
+	int ret = poll(_pollfds.empty() ? NULL : &_pollfds[0], _pollfds.size(), timeoutMs);
+	if (ret < 0)
+		return errno == EINTR ? 0 : -1;
+
+	for (size_t i = 0; i < _pollfds.size() && static_cast<int>(ready.size()) < ret; ++i) {
+		short revents = _pollfds[i].revents;
+		if (revents == 0)
+			continue;
+
+		Event ev;
+		ev.fd = _pollfds[i].fd;
+		ev.events = 0;
+		if (revents & POLLIN)
+			ev.events |= EVENT_READ;
+		if (revents & POLLOUT)
+			ev.events |= EVENT_WRITE;
+		if (revents & (POLLERR | POLLHUP | POLLNVAL))
+			ev.events |= EVENT_ERROR;
+		ready.push_back(ev);
+	}
+	return ready.size();
+}
+
+const char* PollPoller::getName() const {
+	return "poll";
+}
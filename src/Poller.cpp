@@ -0,0 +1,39 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Poller.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:02:11 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:02:11 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Poller.hpp"
+#include "PollPoller.hpp"
+#include "EpollPoller.hpp"
+#include "UringPoller.hpp"
+#include <iostream>
+
+Poller* Poller::create(const std::string& engine) {
+#ifdef __linux__
+	if (engine == "io_uring") {
+		UringPoller* poller = new UringPoller();
+		if (poller->isValid())
+			return poller;
+		delete poller;
+		std::cerr << "Warning: io_uring unavailable, falling back to epoll" << std::endl;
+	}
+	if (engine == "epoll" || engine == "io_uring") {
+		EpollPoller* poller = new EpollPoller();
+		if (poller->isValid())
+			return poller;
+		delete poller;
+		std::cerr << "Warning: epoll unavailable, falling back to poll" << std::endl;
+	}
+#else
+	(void)engine;
+#endif
+	return new PollPoller();
+}
@@ -0,0 +1,91 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorPool.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 14:31:08 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 14:31:08 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ReactorPool.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+
+// Capacidad de cada cola de traspaso: si un bucle va tan atrasado que la
+// llena, el aceptador prueba con los demás
+static const size_t HANDOFF_CAPACITY = 4096;
+
+ReactorPool::ReactorPool(const std::vector<ServerConfig>& configs, const GlobalConfig& global,
+						 size_t threads, ConnectionLimiter* limiter)
+	: _leastConn(global.threadBalance == "least_conn"), _next(0) {
+	std::vector<Server*> noServers;	// los bucles no escuchan: sólo reciben clientes
+	for (size_t i = 0; i < threads; ++i) {
+		HandoffQueue* queue = new HandoffQueue(HANDOFF_CAPACITY);
+		Listener* loop = new Listener(noServers, configs, global);
+		loop->attachInbox(queue, i);
+		loop->setLimiter(limiter);
+		_queues.push_back(queue);
+		_loops.push_back(loop);
+	}
+}
+
+ReactorPool::~ReactorPool() {
+	// Los bucles no terminan en funcionamiento normal: esperar a que salgan
+	for (size_t i = 0; i < _threads.size(); ++i) {
+		pthread_join(_threads[i], NULL);
+	}
+	for (size_t i = 0; i < _loops.size(); ++i) {
+		delete _loops[i];
+		delete _queues[i];
+	}
+}
+
+void* ReactorPool::loopMain(void* arg) {
+	static_cast<Listener*>(arg)->run();
+	return NULL;
+}
+
+void ReactorPool::start() {
+	for (size_t i = 0; i < _loops.size(); ++i) {
+		pthread_t thread;
+		int err = pthread_create(&thread, NULL, &ReactorPool::loopMain, _loops[i]);
+		if (err != 0)
+			throw std::runtime_error(std::string("Error: pthread_create: ") + std::strerror(err));
+		_threads.push_back(thread);
+	}
+	std::cout << "webserv: " << _loops.size() << " event loop threads ("
+			  << (_leastConn ? "least_conn" : "round_robin") << " balancing)" << std::endl;
+}
+
+size_t ReactorPool::pickLoop() {
+	if (!_leastConn) {
+		size_t index = _next;
+		_next = (_next + 1) % _loops.size();
+		return index;
+	}
+
+	// least_conn: conexiones vivas más las que aún esperan en la cola
+	size_t best = 0;
+	size_t bestLoad = static_cast<size_t>(-1);
+	for (size_t i = 0; i < _loops.size(); ++i) {
+		size_t load = _loops[i]->getActiveConnections() + _queues[i]->size();
+		if (load < bestLoad) {
+			best = i;
+			bestLoad = load;
+		}
+	}
+	return best;
+}
+
+bool ReactorPool::dispatch(const AcceptedClient& client) {
+	size_t first = pickLoop();
+	for (size_t i = 0; i < _queues.size(); ++i) {
+		if (_queues[(first + i) % _queues.size()]->push(client))
+			return true;
+	}
+	return false; // todas las colas llenas
+}
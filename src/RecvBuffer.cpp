@@ -0,0 +1,174 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RecvBuffer.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 10:41:37 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 10:41:37 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "RecvBuffer.hpp"
+#include <cstring>
+
+BufferPool::BufferPool() : _cachedBytes(0) {}
+
+BufferPool::~BufferPool() {
+	for (int i = 0; i < CLASSES; ++i) {
+		for (size_t j = 0; j < _free[i].size(); ++j) {
+			delete[] _free[i][j];
+		}
+	}
+}
+
+// Redondea a la clase de tamaño (potencia de dos entre MIN y MAX_BLOCK)
+size_t BufferPool::blockSize(size_t size) {
+	size_t capacity = MIN_BLOCK;
+	while (capacity < size && capacity < MAX_BLOCK) {
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+int BufferPool::classOf(size_t capacity) {
+	int index = 0;
+	for (size_t c = MIN_BLOCK; c < capacity; c <<= 1) {
+		++index;
+	}
+	return index;
+}
+
+char* BufferPool::acquire(size_t size, size_t& capacity) {
+	capacity = blockSize(size);
+	std::vector<char*>& list = _free[classOf(capacity)];
+	if (!list.empty()) {
+		char* block = list.back();
+		list.pop_back();
+		_cachedBytes -= capacity;
+		return block;
+	}
+	return new char[capacity];
+}
+
+void BufferPool::recycle(char* block, size_t capacity) {
+	if (_cachedBytes + capacity > MAX_CACHED_BYTES) {
+		delete[] block;
+		return;
+	}
+	_free[classOf(capacity)].push_back(block);
+	_cachedBytes += capacity;
+}
+
+RecvBuffer::RecvBuffer() : _pool(NULL), _block(NULL), _capacity(0), _start(0), _end(0) {}
+
+RecvBuffer::~RecvBuffer() {
+	reset();
+}
+
+// Sólo antes del primer bloque: cada bloque vuelve al pool del que salió
+void RecvBuffer::setPool(BufferPool* pool) {
+	if (!_block) {
+		_pool = pool;
+	}
+}
+
+const char* RecvBuffer::data() const {
+	return _block + _start;
+}
+
+size_t RecvBuffer::size() const {
+	return _end - _start;
+}
+
+bool RecvBuffer::empty() const {
+	return _start == _end;
+}
+
+size_t RecvBuffer::capacity() const {
+	return _capacity;
+}
+
+size_t RecvBuffer::prepare(size_t space) {
+	size_t pending = _end - _start;
+	if (space > BufferPool::MAX_BLOCK - pending) {
+		space = BufferPool::MAX_BLOCK > pending ? BufferPool::MAX_BLOCK - pending : 0;
+	}
+	
+	if (_capacity - _end < space) {
+		if (_capacity - pending >= space) {
+			// Cabe moviendo lo pendiente al principio
+			std::memmove(_block, _block + _start, pending);
+			_start = 0;
+			_end = pending;
+		} else {
+			reallocate(pending + space);
+		}
+	}
+	return _capacity - _end;
+}
+
+char* RecvBuffer::writePtr() {
+	return _block + _end;
+}
+
+void RecvBuffer::commit(size_t bytes) {
+	_end += bytes;
+}
+
+void RecvBuffer::consume(size_t bytes) {
+	_start += bytes;
+	if (_start == _end) {
+		_start = _end = 0;
+	}
+}
+
+void RecvBuffer::release() {
+	if (!_block || _start != _end)
+		return;
+	if (_pool) {
+		_pool->recycle(_block, _capacity);
+	} else {
+		delete[] _block;
+	}
+	_block = NULL;
+	_capacity = 0;
+	_start = _end = 0;
+}
+
+void RecvBuffer::reset() {
+	_start = _end = 0;
+	release();
+}
+
+void RecvBuffer::reallocate(size_t capacity) {
+	size_t pending = _end - _start;
+	size_t newCapacity;
+	char* block;
+	if (_pool) {
+		block = _pool->acquire(capacity, newCapacity);
+	} else {
+		newCapacity = BufferPool::blockSize(capacity);
+		block = new char[newCapacity];
+	}
+	
+	if (pending > 0) {
+		std::memcpy(block, _block + _start, pending);
+	}
+	_start = 0;
+	_end = pending;
+	
+	// El bloque viejo ya no tiene nada pendiente
+	char* old = _block;
+	size_t oldCapacity = _capacity;
+	_block = block;
+	_capacity = newCapacity;
+	if (old) {
+		if (_pool) {
+			_pool->recycle(old, oldCapacity);
+		} else {
+			delete[] old;
+		}
+	}
+}
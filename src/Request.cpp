@@ -11,15 +11,44 @@
 /* ************************************************************************** */
 
 #include "Request.hpp"
-#include <sstream>
+#include "Utils.hpp"
+#include "HttpScan.hpp"
 #include <algorithm>
-#include <cctype>
-#include <iostream>
+#include <cstring>
+#include <strings.h>
 
-Request::Request() : _state(REQUEST_LINE), _contentLength(0), _chunked(false) {}
+// Línea de tamaño de chunk (con extensiones) o de trailer más larga que se
+// acepta; no se guardan, pero así un cliente no puede alargarlas sin fin
+static const size_t CHUNK_LINE_MAX = 4096;
+
+// 15 dígitos hexadecimales no desbordan size_t de 64 bits
+static const size_t CHUNK_SIZE_DIGITS_MAX = 15;
+
+static bool isSpace(char c) {
+	return c == ' ' || c == '\t';
+}
+
+static int hexValue(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+Request::Request()
+	: _state(REQUEST_LINE), _lineStart(0), _scan(0), _contentLength(0), _chunked(false),
+	  _bodyLimit(0), _errorStatus(400), _maxRequestLine(8 * 1024), _maxHeaderSize(32 * 1024),
+	  _maxHeaderCount(100), _chunkState(CHUNK_SIZE), _chunkSize(0), _chunkDigits(0),
+	  _chunkRemaining(0), _chunkLine(0), _chunkCr(false), _trailerSize(0), _trailerCount(0) {
+	std::fill(_known, _known + HEADER_COUNT, 0);
+}
 
 Request::~Request() {}
 
+// clear() conserva la capacidad de los strings para la siguiente petición
 void Request::reset() {
 	_state = REQUEST_LINE;
 	_method.clear();
@@ -27,77 +56,173 @@ void Request::reset() {
 	_path.clear();
 	_query.clear();
 	_version.clear();
-	_headers.clear();
-	_body.clear();
-	_buffer.clear();
+	_head.clear();
+	_fields.clear();
+	std::fill(_known, _known + HEADER_COUNT, 0);
+	_lineStart = 0;
+	_scan = 0;
+	_body.reset();
 	_contentLength = 0;
 	_chunked = false;
+	_bodyLimit = 0;
+	_errorStatus = 400;
+	_chunkState = CHUNK_SIZE;
+	_chunkSize = 0;
+	_chunkDigits = 0;
+	_chunkRemaining = 0;
+	_chunkLine = 0;
+	_chunkCr = false;
+	_trailerSize = 0;
+	_trailerCount = 0;
 }
 
-bool Request::parseChunk(const std::string& chunk) {
-	if (_state == ERROR || _state == COMPLETE) {
-		return false;
+// Para reutilizar el objeto: el body puede haber crecido hasta el tamaño
+// de un upload
+size_t Request::releaseBuffers(size_t maxCapacity) {
+	reset();
+	return _body.releaseBuffers(maxCapacity) + Utils::trimCapacity(_head, maxCapacity);
+}
+
+size_t Request::parse(const char* data, size_t len) {
+	if (_state == REQUEST_LINE || _state == HEADERS) {
+		if (!parseHead(data, len)) {
+			return 0;
+		}
+		return _head.size();
 	}
-	
-	_buffer += chunk;
-	
-	while (_state != COMPLETE && _state != ERROR) {
-		if (_state == REQUEST_LINE) {
-			size_t pos = _buffer.find("\r\n");
-			if (pos == std::string::npos)
-				break;
-			
-			if (!parseRequestLine(_buffer.substr(0, pos))) {
+	if (_state == BODY) {
+		return _chunked ? parseChunked(data, len) : parseBody(data, len);
+	}
+	return 0;
+}
+
+// Lo fija ClientConnection en cuanto sabe a qué server/location va la
+// petición; se aplica al body ya decodificado
+void Request::setBodyLimit(size_t limit) {
+	_bodyLimit = limit;
+}
+
+void Request::setHeaderLimits(size_t requestLine, size_t headerSize, size_t headerCount) {
+	_maxRequestLine = requestLine;
+	_maxHeaderSize = headerSize;
+	_maxHeaderCount = headerCount;
+}
+
+void Request::setBodyBuffering(size_t memoryLimit, const std::string& tempDir) {
+	_body.configure(memoryLimit, tempDir);
+}
+
+void Request::fail(int status) {
+	_state = ERROR;
+	_errorStatus = status;
+}
+
+// Recorre línea a línea desde donde lo dejó la llamada anterior. Devuelve
+// true cuando la cabecera está completa (y ya copiada en _head). La misma
+// búsqueda que encuentra el fin de línea rechaza los bytes de control que
+// no pueden aparecer en una cabecera (NUL, CR suelto...).
+bool Request::parseHead(const char* data, size_t len) {
+	const char* end = data + len;
+	while (_scan < len) {
+		const char* stop = HttpScan::findControl(data + _scan, end);
+		if (stop == end) {
+			_scan = len;
+			withinHeadLimits(len);
+			return false;
+		}
+		
+		size_t contentEnd = stop - data;
+		if (!withinHeadLimits(contentEnd)) {
+			return false;
+		}
+		if (*stop == '\r') {
+			// Falta ver qué viene detrás del CR: se vuelve a mirar desde aquí
+			if (stop + 1 == end) {
+				_scan = contentEnd;
+				return false;
+			}
+			if (stop[1] != '\n') {
 				_state = ERROR;
 				return false;
 			}
-			
-			_buffer.erase(0, pos + 2);
-			_state = HEADERS;
+			++stop;
+		} else if (*stop != '\n') {
+			_state = ERROR;
+			return false;
 		}
-		else if (_state == HEADERS) {
-			if (!parseHeaders()) {
-				break;
-			}
-			
-			if (_method != "GET" && _method != "HEAD") {
-				_state = BODY;
-			} else {
-				_state = COMPLETE;
+		_scan = (stop - data) + 1;
+		
+		if (_state == REQUEST_LINE) {
+			// Las líneas vacías antes de la petición se ignoran (RFC 9112 2.2)
+			if (contentEnd > _lineStart) {
+				if (!parseRequestLine(data + _lineStart, contentEnd - _lineStart)) {
+					_state = ERROR;
+					return false;
+				}
+				_state = HEADERS;
 			}
-		}
-		else if (_state == BODY) {
-			if (!parseBody()) {
-				break;
+		} else if (contentEnd == _lineStart) {
+			return finishHead(data, _scan);
+		} else {
+			addField(data, _lineStart, contentEnd);
+			if (_fields.size() > _maxHeaderCount) {
+				fail(431);
+				return false;
 			}
-			_state = COMPLETE;
 		}
+		_lineStart = _scan;
 	}
-	
-	return _state == COMPLETE;
+	return false;
 }
 
-bool Request::parseRequestLine(const std::string& line) {
-	std::istringstream iss(line);
-	
-	if (!(iss >> _method >> _uri >> _version)) {
+// Con 'received' bytes de cabecera ya vistos (la línea en curso puede estar
+// sin terminar). Se comprueba según llegan, así que lo que ocupa la cabecera
+// de una conexión nunca pasa de _maxHeaderSize
+bool Request::withinHeadLimits(size_t received) {
+	if (_state == REQUEST_LINE && received - _lineStart > _maxRequestLine) {
+		fail(414);
+		return false;
+	}
+	if (received > _maxHeaderSize) {
+		fail(431);
 		return false;
 	}
+	return true;
+}
+
+bool Request::parseRequestLine(const char* line, size_t len) {
+	const char* end = line + len;
+	const char* parts[3];
+	size_t lengths[3];
+	const char* p = line;
 	
-	parseUri();
+	// método SP uri SP versión
+	for (int i = 0; i < 3; ++i) {
+		while (p < end && isSpace(*p))
+			++p;
+		parts[i] = p;
+		while (p < end && !isSpace(*p))
+			++p;
+		lengths[i] = p - parts[i];
+		if (lengths[i] == 0)
+			return false;
+	}
+	while (p < end && isSpace(*p))
+		++p;
+	if (p != end)
+		return false;
 	
-	// Validar que el método sea un token HTTP válido
-	// Aceptamos cualquier método HTTP válido, no solo los implementados
-	// Los métodos HTTP son tokens que consisten en letras mayúsculas, dígitos y algunos caracteres especiales
-	if (_method.empty()) {
+	_method.assign(parts[0], lengths[0]);
+	_uri.assign(parts[1], lengths[1]);
+	_version.assign(parts[2], lengths[2]);
+	if (!parseUri()) {
 		return false;
 	}
-	// Verificar que el método sea un token válido (letras, dígitos, y algunos caracteres especiales permitidos)
-	for (size_t i = 0; i < _method.length(); ++i) {
-		char c = _method[i];
-		if (!std::isalnum(c) && c != '-' && c != '_' && c != '.') {
-			return false; // Método inválido
-		}
+	
+	// El método es un token HTTP (RFC 9110 9.1); se aceptan también los que
+	// no están implementados y el router responde 501/405
+	if (HttpScan::findNonToken(parts[0], parts[0] + lengths[0]) != parts[0] + lengths[0]) {
+		return false;
 	}
 	
 	if (_version != "HTTP/1.0" && _version != "HTTP/1.1") {
@@ -107,82 +232,299 @@ bool Request::parseRequestLine(const std::string& line) {
 	return true;
 }
 
-bool Request::parseHeaders() {
-	size_t pos = _buffer.find("\r\n\r\n");
-	if (pos == std::string::npos) {
-		return false;
-	}
+// Guarda "nombre: valor" como posiciones. Las líneas cuyo nombre no es un
+// token terminado en ':' (sin ':', espacios antes de ':', caracteres raros)
+// se ignoran, como hace nginx con ignore_invalid_headers.
+void Request::addField(const char* data, size_t start, size_t end) {
+	const char* colon = HttpScan::findNonToken(data + start, data + end);
+	if (colon == data + start || colon == data + end || *colon != ':')
+		return;
 	
-	std::string headersStr = _buffer.substr(0, pos);
-	_buffer.erase(0, pos + 4);
+	size_t valueStart = (colon - data) + 1;
+	while (valueStart < end && isSpace(data[valueStart]))
+		valueStart++;
+	size_t valueEnd = end;
+	while (valueEnd > valueStart && isSpace(data[valueEnd - 1]))
+		valueEnd--;
 	
-	std::istringstream iss(headersStr);
-	std::string line;
+	HeaderField field;
+	field.id = HttpHeaders::lookup(data + start, (colon - data) - start);
+	field.name.offset = start;
+	field.name.length = (colon - data) - start;
+	field.value.offset = valueStart;
+	field.value.length = valueEnd - valueStart;
+	_fields.push_back(field);
+	// Repetido: gana el último, como hacía el map de antes
+	if (field.id != HEADER_UNKNOWN)
+		_known[field.id] = _fields.size();
+}
+
+// Copia la cabecera entera de una vez (las posiciones siguen valiendo) y
+// decide si viene body
+bool Request::finishHead(const char* data, size_t headEnd) {
+	_head.assign(data, headEnd);
 	
-	while (std::getline(iss, line)) {
-		if (line.empty() || line == "\r") continue;
-		
-		if (!line.empty() && line[line.size() - 1] == '\r') {
-			line.erase(line.size() - 1);
+	const HeaderField* length = findField(HEADER_CONTENT_LENGTH);
+	if (length) {
+		if (length->value.length == 0 || length->value.length > 18) {
+			_state = ERROR;
+			return false;
 		}
-		
-		size_t colon = line.find(':');
-		if (colon == std::string::npos) {
-			continue;
+		_contentLength = 0;
+		for (size_t i = 0; i < length->value.length; ++i) {
+			char c = _head[length->value.offset + i];
+			if (c < '0' || c > '9') {
+				_state = ERROR;
+				return false;
+			}
+			_contentLength = _contentLength * 10 + (c - '0');
 		}
-		
-		std::string key = trim(line.substr(0, colon));
-		std::string value = trim(line.substr(colon + 1));
-		
-		_headers[toLowerCase(key)] = value;
 	}
 	
-	extractContentLength();
+	// Un Transfer-Encoding que no entendemos, o junto a Content-Length, deja
+	// sin saber dónde acaba el body: se rechaza antes de leerlo (RFC 9112 6.1)
+	const HeaderField* encoding = findField(HEADER_TRANSFER_ENCODING);
+	if (encoding) {
+		int status = checkTransferEncoding(*encoding);
+		if (status != 0) {
+			fail(status);
+			return false;
+		}
+		if (length) {
+			fail(400);
+			return false;
+		}
+		_chunked = true;
+	}
+	
+	// Un GET con body también lo lee entero: si no, sus bytes se tomarían
+	// por la siguiente petición
+	if ((_method != "GET" && _method != "HEAD") || _chunked || _contentLength > 0) {
+		if (!_body.expect(_contentLength)) {
+			fail(500);
+			return false;
+		}
+		_state = BODY;
+	} else {
+		_state = COMPLETE;
+	}
 	return true;
 }
 
-bool Request::parseBody() {
-	if (_chunked) {
-		return false;
+// El body se va copiando según llega; no hace falta tenerlo entero en el
+// buffer de recepción
+size_t Request::parseBody(const char* data, size_t len) {
+	size_t take = std::min(len, getRemainingBody());
+	if (!_body.append(data, take)) {
+		fail(500);
+		return take;
 	}
-	
-	if (_contentLength == 0) {
-		_body.clear();
-		return true;
+	if (_body.size() >= _contentLength) {
+		_state = COMPLETE;
 	}
-	
-	if (_buffer.size() < _contentLength) {
-		return false;
+	return take;
+}
+
+// Decodificador chunked incremental. Los datos de cada chunk van directos
+// del buffer de recepción al body; de las líneas de tamaño, extensiones y
+// trailers sólo se guarda el estado, así que se pueden cortar en cualquier
+// byte entre dos lecturas.
+size_t Request::parseChunked(const char* data, size_t len) {
+	size_t pos = 0;
+	while (pos < len && _state == BODY) {
+		if (_chunkState == CHUNK_DATA) {
+			size_t take = std::min(len - pos, _chunkRemaining);
+			if (!_body.append(data + pos, take)) {
+				fail(500);
+				break;
+			}
+			pos += take;
+			_chunkRemaining -= take;
+			if (_chunkRemaining == 0)
+				_chunkState = CHUNK_DATA_END;
+			continue;
+		}
+		
+		char c = data[pos++];
+		// Los trailers son una segunda cabecera: su tamaño se suma al de la
+		// primera, o un cliente podría mandar trailers sin fin
+		if (_chunkState == CHUNK_TRAILER && _head.size() + ++_trailerSize > _maxHeaderSize) {
+			fail(431);
+			break;
+		}
+		if (_chunkCr && c != '\n') {
+			fail(400);
+			break;
+		}
+		if (c == '\r') {
+			_chunkCr = true;
+			continue;
+		}
+		if (c == '\n') {
+			_chunkCr = false;
+			if (!endChunkLine())
+				break;
+			_chunkLine = 0;
+			continue;
+		}
+		if (++_chunkLine > CHUNK_LINE_MAX) {
+			fail(400);
+			break;
+		}
+		
+		if (_chunkState == CHUNK_SIZE) {
+			int digit = hexValue(c);
+			if (digit >= 0 && _chunkDigits < CHUNK_SIZE_DIGITS_MAX) {
+				_chunkSize = _chunkSize * 16 + digit;
+				_chunkDigits++;
+			} else if (_chunkDigits > 0 && c == ';') {
+				_chunkState = CHUNK_EXTENSION;
+			} else if (_chunkDigits > 0 && isSpace(c)) {
+				_chunkState = CHUNK_SIZE_END;
+			} else {
+				fail(400);
+			}
+		} else if (_chunkState == CHUNK_SIZE_END) {
+			// "1 ;ext" vale; "1 basura" no
+			if (c == ';') {
+				_chunkState = CHUNK_EXTENSION;
+			} else if (!isSpace(c)) {
+				fail(400);
+			}
+		} else if (_chunkState == CHUNK_DATA_END
+				   || HttpScan::isControl(static_cast<unsigned char>(c))) {
+			// Tras los datos sólo puede venir el CRLF; en extensiones y
+			// trailers vale cualquier cosa menos bytes de control
+			fail(400);
+		}
+	}
+	return pos;
+}
+
+// Fin de una línea del formato chunked. Devuelve false si la petición ha
+// terminado (completa o con error)
+bool Request::endChunkLine() {
+	switch (_chunkState) {
+		case CHUNK_SIZE:
+		case CHUNK_SIZE_END:
+		case CHUNK_EXTENSION:
+			if (_chunkDigits == 0) {
+				fail(400);
+				return false;
+			}
+			if (_chunkSize == 0) {
+				_chunkState = CHUNK_TRAILER;
+				return true;
+			}
+			// Se rechaza en cuanto el tamaño anunciado pasa del límite, sin
+			// esperar a recibir los datos
+			if (_bodyLimit > 0 && _chunkSize > _bodyLimit - std::min(_bodyLimit, _body.size())) {
+				fail(413);
+				return false;
+			}
+			_chunkRemaining = _chunkSize;
+			_chunkSize = 0;
+			_chunkDigits = 0;
+			_chunkState = CHUNK_DATA;
+			return true;
+		case CHUNK_DATA_END:
+			_chunkState = CHUNK_SIZE;
+			return true;
+		case CHUNK_TRAILER:
+			if (_chunkLine > 0) {
+				// Un trailer más, que cuenta como un header
+				if (_fields.size() + ++_trailerCount > _maxHeaderCount) {
+					fail(431);
+					return false;
+				}
+				return true;
+			}
+			// Línea vacía: fin del mensaje. Desde aquí el body se trata
+			// como si hubiera llegado con Content-Length
+			_contentLength = _body.size();
+			_state = COMPLETE;
+			return false;
+		default:
+			return true;
 	}
-	
-	_body = _buffer.substr(0, _contentLength);
-	_buffer.erase(0, _contentLength);
-	
-	return true;
 }
 
-void Request::parseUri() {
+// La query queda tal cual llega; la ruta, decodificada y normalizada
+bool Request::parseUri() {
 	size_t queryPos = _uri.find('?');
 	if (queryPos != std::string::npos) {
-		_path = _uri.substr(0, queryPos);
-		_query = _uri.substr(queryPos + 1);
+		_query.assign(_uri, queryPos + 1, std::string::npos);
 	} else {
-		_path = _uri;
+		queryPos = _uri.size();
 		_query.clear();
 	}
+	return Utils::normalizePath(_uri.data(), queryPos, _path);
+}
+
+const Request::HeaderField* Request::findField(HeaderId id) const {
+	if (id >= HEADER_COUNT || _known[id] == 0)
+		return NULL;
+	return &_fields[_known[id] - 1];
 }
 
-void Request::extractContentLength() {
-	std::map<std::string, std::string>::const_iterator it = _headers.find("content-length");
-	if (it != _headers.end()) {
-		std::istringstream iss(it->second);
-		iss >> _contentLength;
+// Nombres arbitrarios: si es uno conocido va por su id; si no, se busca
+// entre los demás (el último con ese nombre gana)
+const Request::HeaderField* Request::findField(const std::string& key) const {
+	HeaderId id = HttpHeaders::lookup(key.data(), key.size());
+	if (id != HEADER_UNKNOWN)
+		return findField(id);
+	for (size_t i = _fields.size(); i > 0; --i) {
+		const HeaderField& field = _fields[i - 1];
+		if (field.id == HEADER_UNKNOWN && field.name.length == key.size()
+			&& strncasecmp(_head.data() + field.name.offset, key.data(), key.size()) == 0)
+			return &field;
 	}
-	
-	std::map<std::string, std::string>::const_iterator it2 = _headers.find("transfer-encoding");
-	if (it2 != _headers.end() && toLowerCase(it2->second).find("chunked") != std::string::npos) {
-		_chunked = true;
+	return NULL;
+}
+
+bool Request::fieldContains(const HeaderField& field, const char* token) const {
+	size_t tokenLen = std::strlen(token);
+	const char* value = _head.data() + field.value.offset;
+	for (size_t i = 0; i + tokenLen <= field.value.length; ++i) {
+		if (strncasecmp(value + i, token, tokenLen) == 0)
+			return true;
 	}
+	return false;
+}
+
+// Transfer-Encoding: sólo se decodifica chunked, y tiene que ser la última
+// (y única) codificación. chunked antes de otra o repetido deja el final del
+// body sin definir (400); otras codificaciones no se implementan (501)
+int Request::checkTransferEncoding(const HeaderField& field) const {
+	const char* value = _head.data() + field.value.offset;
+	size_t end = field.value.length;
+	size_t tokens = 0;
+	size_t chunked = 0;
+	bool lastChunked = false;
+	size_t pos = 0;
+	while (pos <= end) {
+		size_t comma = pos;
+		while (comma < end && value[comma] != ',')
+			++comma;
+		size_t start = pos;
+		size_t stop = comma;
+		while (start < stop && isSpace(value[start]))
+			++start;
+		while (stop > start && isSpace(value[stop - 1]))
+			--stop;
+		// Elementos vacíos de la lista (", ,") se ignoran
+		if (stop > start) {
+			tokens++;
+			lastChunked = stop - start == 7 && strncasecmp(value + start, "chunked", 7) == 0;
+			chunked += lastChunked;
+		}
+		pos = comma + 1;
+	}
+	if (chunked > 1 || (chunked == 1 && !lastChunked) || tokens == 0)
+		return 400;
+	if (tokens > 1 || !lastChunked)
+		return 501;
+	return 0;
 }
 
 const std::string& Request::getMethod() const {
@@ -205,20 +547,27 @@ const std::string& Request::getVersion() const {
 	return _version;
 }
 
-const std::string& Request::getHeader(const std::string& key) const {
-	static const std::string empty;
-	std::map<std::string, std::string>::const_iterator it = _headers.find(toLowerCase(key));
-	if (it != _headers.end()) {
-		return it->second;
+std::string Request::getHeader(HeaderId id) const {
+	const HeaderField* field = findField(id);
+	if (!field) {
+		return std::string();
 	}
-	return empty;
+	return _head.substr(field->value.offset, field->value.length);
 }
 
-const std::map<std::string, std::string>& Request::getHeaders() const {
-	return _headers;
+std::string Request::getHeader(const std::string& key) const {
+	const HeaderField* field = findField(key);
+	if (!field) {
+		return std::string();
+	}
+	return _head.substr(field->value.offset, field->value.length);
+}
+
+const BodySink& Request::getBody() const {
+	return _body;
 }
 
-const std::string& Request::getBody() const {
+BodySink& Request::getBody() {
 	return _body;
 }
 
@@ -226,43 +575,56 @@ RequestState Request::getState() const {
 	return _state;
 }
 
+int Request::getErrorStatus() const {
+	return _errorStatus;
+}
+
 size_t Request::getContentLength() const {
 	return _contentLength;
 }
 
+// Con chunked, lo que falta del chunk en curso
+size_t Request::getRemainingBody() const {
+	if (_chunked)
+		return _chunkState == CHUNK_DATA ? _chunkRemaining : 0;
+	return _body.size() < _contentLength ? _contentLength - _body.size() : 0;
+}
+
 bool Request::isComplete() const {
 	return _state == COMPLETE;
 }
 
+// Hay una petición empezada (parseo más allá de la línea de petición)
+bool Request::hasPendingData() const {
+	return _state != REQUEST_LINE;
+}
+
+bool Request::hasHeader(HeaderId id) const {
+	return findField(id) != NULL;
+}
+
 bool Request::hasHeader(const std::string& key) const {
-	return _headers.find(toLowerCase(key)) != _headers.end();
+	return findField(key) != NULL;
 }
 
-bool Request::isChunked() const {
-	return _chunked;
+bool Request::headerEquals(HeaderId id, const char* value) const {
+	const HeaderField* field = findField(id);
+	size_t len = std::strlen(value);
+	return field && field->value.length == len
+		&& strncasecmp(_head.data() + field->value.offset, value, len) == 0;
 }
 
-bool Request::isMultipart() const {
-	std::map<std::string, std::string>::const_iterator it = _headers.find("content-type");
-	if (it != _headers.end()) {
-		return it->second.find("multipart/form-data") != std::string::npos;
-	}
-	return false;
+// Sin Connection (o vacío) se mantiene abierta, como hasta ahora
+bool Request::keepAlive() const {
+	const HeaderField* field = findField(HEADER_CONNECTION);
+	return !field || field->value.length == 0 || headerEquals(HEADER_CONNECTION, "keep-alive");
 }
 
-std::string Request::toLowerCase(const std::string& str) const {
-	std::string result = str;
-	for (size_t i = 0; i < result.size(); ++i) {
-		result[i] = std::tolower(result[i]);
-	}
-	return result;
+bool Request::isChunked() const {
+	return _chunked;
 }
 
-std::string Request::trim(const std::string& str) const {
-	size_t start = str.find_first_not_of(" \t\r\n");
-	if (start == std::string::npos) {
-		return "";
-	}
-	size_t end = str.find_last_not_of(" \t\r\n");
-	return str.substr(start, end - start + 1);
+bool Request::isMultipart() const {
+	const HeaderField* field = findField(HEADER_CONTENT_TYPE);
+	return field && fieldContains(*field, "multipart/form-data");
 }
@@ -11,88 +11,273 @@
 /* ************************************************************************** */
 
 #include "Response.hpp"
-#include <sstream>
+#include "Utils.hpp"
+#include "StaticCache.hpp"
 #include <ctime>
-#include <iomanip>
 #include <cstring>
+#include <algorithm>
+#include <strings.h>
+#include <unistd.h>
 
-Response::Response() : _statusCode(200), _statusMessage("OK") {
-	setHeader("Server", "webserv/1.0");
-	setHeader("Date", getDateHeader());
+namespace {
+
+// Líneas de estado ya montadas para los códigos que responde el servidor
+struct StatusLine {
+	int code;
+	const char* line;
+};
+
+const StatusLine STATUS_LINES[] = {
+	{ 100, "HTTP/1.1 100 Continue\r\n" },
+	{ 200, "HTTP/1.1 200 OK\r\n" },
+	{ 201, "HTTP/1.1 201 Created\r\n" },
+	{ 204, "HTTP/1.1 204 No Content\r\n" },
+	{ 206, "HTTP/1.1 206 Partial Content\r\n" },
+	{ 301, "HTTP/1.1 301 Moved Permanently\r\n" },
+	{ 302, "HTTP/1.1 302 Found\r\n" },
+	{ 304, "HTTP/1.1 304 Not Modified\r\n" },
+	{ 400, "HTTP/1.1 400 Bad Request\r\n" },
+	{ 403, "HTTP/1.1 403 Forbidden\r\n" },
+	{ 404, "HTTP/1.1 404 Not Found\r\n" },
+	{ 405, "HTTP/1.1 405 Method Not Allowed\r\n" },
+	{ 408, "HTTP/1.1 408 Request Timeout\r\n" },
+	{ 412, "HTTP/1.1 412 Precondition Failed\r\n" },
+	{ 413, "HTTP/1.1 413 Payload Too Large\r\n" },
+	{ 414, "HTTP/1.1 414 URI Too Long\r\n" },
+	{ 416, "HTTP/1.1 416 Range Not Satisfiable\r\n" },
+	{ 417, "HTTP/1.1 417 Expectation Failed\r\n" },
+	{ 431, "HTTP/1.1 431 Request Header Fields Too Large\r\n" },
+	{ 500, "HTTP/1.1 500 Internal Server Error\r\n" },
+	{ 501, "HTTP/1.1 501 Not Implemented\r\n" },
+	{ 502, "HTTP/1.1 502 Bad Gateway\r\n" },
+	{ 503, "HTTP/1.1 503 Service Unavailable\r\n" },
+	{ 504, "HTTP/1.1 504 Gateway Timeout\r\n" },
+	{ 505, "HTTP/1.1 505 HTTP Version Not Supported\r\n" }
+};
+
+const size_t STATUS_COUNT = sizeof(STATUS_LINES) / sizeof(STATUS_LINES[0]);
+
+// "HTTP/1.1 NNN " delante del texto y "\r\n" detrás
+const size_t STATUS_PREFIX = 13;
+
+const char* findStatusLine(int code) {
+	for (size_t i = 0; i < STATUS_COUNT; ++i) {
+		if (STATUS_LINES[i].code == code)
+			return STATUS_LINES[i].line;
+	}
+	return NULL;
+}
+
+// Date compartido por todos los hilos. Hay dos copias: la nueva se escribe
+// en la que no se está leyendo y después se publica. Sólo el hilo que gana
+// el compare-and-swap del segundo la rehace
+const size_t DATE_LEN = 29;	// "Sun, 06 Nov 1994 08:49:37 GMT"
+char g_dates[2][DATE_LEN + 1];
+int g_dateSlot = 0;
+time_t g_dateSecond = 0;
+
+const char* currentDate() {
+	if (__atomic_load_n(&g_dateSecond, __ATOMIC_ACQUIRE) == 0)
+		Response::refreshDate(time(NULL));
+	return g_dates[__atomic_load_n(&g_dateSlot, __ATOMIC_ACQUIRE)];
+}
+
+}
+
+Response::Response()
+	: _statusCode(200), _statusLine(findStatusLine(200)), _bodyFile(-1), _bodyFileSize(0),
+	  _cached(NULL) {
+	std::fill(_present, _present + HEADER_COUNT, false);
+	setHeader(HEADER_SERVER, "webserv/1.0");
+	_present[HEADER_DATE] = true;	// el valor lo pone serializeHead
+}
+
+Response::~Response() {
+	dropBodySources();
 }
 
-Response::~Response() {}
+// Lo llama el bucle de eventos en cada vuelta; sólo formatea si ha cambiado
+// el segundo
+void Response::refreshDate(time_t now) {
+	time_t last = __atomic_load_n(&g_dateSecond, __ATOMIC_ACQUIRE);
+	if (now <= last || !__atomic_compare_exchange_n(&g_dateSecond, &last, now, false,
+													__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		return;
+	
+	int next = 1 - __atomic_load_n(&g_dateSlot, __ATOMIC_RELAXED);
+	struct tm gmt;
+	gmtime_r(&now, &gmt);	// gmtime() usa un buffer estático compartido entre hilos
+	strftime(g_dates[next], sizeof(g_dates[next]), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+	__atomic_store_n(&g_dateSlot, next, __ATOMIC_RELEASE);
+}
 
+// Con un código de la tabla y sin texto propio se usa su línea ya montada
 void Response::setStatus(int code, const std::string& message) {
 	_statusCode = code;
-	if (message.empty()) {
-		_statusMessage = getStatusMessageForCode(code);
-	} else {
-		_statusMessage = message;
+	_statusLine = message.empty() ? findStatusLine(code) : NULL;
+	if (!_statusLine) {
+		_statusMessage = message.empty() ? "Unknown" : message;
 	}
 }
 
+void Response::setHeader(HeaderId id, const std::string& value) {
+	if (id >= HEADER_COUNT)
+		return;
+	_known[id] = value;
+	_present[id] = true;
+}
+
+void Response::setHeader(HeaderId id, const char* value) {
+	if (id >= HEADER_COUNT)
+		return;
+	_known[id] = value;
+	_present[id] = true;
+}
+
 void Response::setHeader(const std::string& key, const std::string& value) {
-	_headers[key] = value;
+	HeaderId id = HttpHeaders::lookup(key.data(), key.size());
+	if (id != HEADER_UNKNOWN) {
+		setHeader(id, value);
+		return;
+	}
+	size_t index = findExtra(key);
+	if (index < _extra.size()) {
+		_extra[index].second = value;
+	} else {
+		_extra.push_back(std::make_pair(key, value));
+	}
+}
+
+// Posición en _extra del header con ese nombre, o _extra.size()
+size_t Response::findExtra(const std::string& key) const {
+	size_t i = 0;
+	while (i < _extra.size() && !(_extra[i].first.size() == key.size()
+		   && strncasecmp(_extra[i].first.data(), key.data(), key.size()) == 0))
+		++i;
+	return i;
 }
 
 void Response::setBody(const std::string& body) {
+	dropBodySources();
 	_body = body;
-	setHeader("Content-Length", toString(_body.size()));
+	setNumber(HEADER_CONTENT_LENGTH, _body.size());
 }
 
 void Response::setBody(const char* data, size_t size) {
+	dropBodySources();
 	_body.assign(data, size);
-	setHeader("Content-Length", toString(_body.size()));
-}
-
-std::string Response::toString(size_t value) const {
-	std::ostringstream oss;
-	oss << value;
-	return oss.str();
-}
-
-std::string Response::getStatusMessageForCode(int code) const {
-	switch (code) {
-		case 200: return "OK";
-		case 201: return "Created";
-		case 204: return "No Content";
-		case 301: return "Moved Permanently";
-		case 400: return "Bad Request";
-		case 403: return "Forbidden";
-		case 404: return "Not Found";
-		case 405: return "Method Not Allowed";
-		case 408: return "Request Timeout";
-		case 413: return "Payload Too Large";
-		case 414: return "URI Too Long";
-		case 500: return "Internal Server Error";
-		case 501: return "Not Implemented";
-		case 502: return "Bad Gateway";
-		case 503: return "Service Unavailable";
-		case 504: return "Gateway Timeout";
-		default: return "Unknown";
+	setNumber(HEADER_CONTENT_LENGTH, _body.size());
+}
+
+void Response::swapBody(std::string& body) {
+	dropBodySources();
+	_body.swap(body);
+	setNumber(HEADER_CONTENT_LENGTH, _body.size());
+}
+
+void Response::setBodyFile(int fd, size_t size) {
+	dropBodySources();
+	_body.clear();
+	_bodyFile = fd;
+	_bodyFileSize = size;
+	setNumber(HEADER_CONTENT_LENGTH, size);
+}
+
+void Response::takeBodyFile(int& fd, size_t& size) {
+	fd = _bodyFile;
+	size = _bodyFileSize;
+	_bodyFile = -1;
+	_bodyFileSize = 0;
+}
+
+void Response::setCachedBody(CachedFile* file) {
+	dropBodySources();
+	_body.clear();
+	StaticCache::retain(file);
+	_cached = file;
+	// Estos salen ya escritos en la entrada
+	_present[HEADER_CONTENT_TYPE] = false;
+	_present[HEADER_CONTENT_LENGTH] = false;
+	_present[HEADER_LAST_MODIFIED] = false;
+	_present[HEADER_ETAG] = false;
+}
+
+CachedFile* Response::takeCachedBody() {
+	CachedFile* file = _cached;
+	_cached = NULL;
+	return file;
+}
+
+void Response::setBodyLength(size_t size) {
+	dropBodySources();
+	_body.clear();
+	setNumber(HEADER_CONTENT_LENGTH, size);
+}
+
+// Fichero abierto o entrada de la caché que aporta el body, si hay
+void Response::dropBodySources() {
+	if (_bodyFile >= 0) {
+		::close(_bodyFile);
 	}
+	_bodyFile = -1;
+	_bodyFileSize = 0;
+	if (_cached) {
+		StaticCache::release(_cached);
+		_cached = NULL;
+	}
+}
+
+// Sin pasar por un stream: los dígitos van directos al hueco del header
+void Response::setNumber(HeaderId id, size_t value) {
+	char digits[24];
+	size_t pos = sizeof(digits);
+	do {
+		digits[--pos] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	_known[id].assign(digits + pos, sizeof(digits) - pos);
+	_present[id] = true;
 }
 
 int Response::getStatus() const {
 	return _statusCode;
 }
 
-const std::string& Response::getStatusMessage() const {
-	return _statusMessage;
+std::string Response::getStatusMessage() const {
+	if (!_statusLine) {
+		return _statusMessage;
+	}
+	return std::string(_statusLine + STATUS_PREFIX, std::strlen(_statusLine) - STATUS_PREFIX - 2);
+}
+
+const std::string& Response::getHeader(HeaderId id) const {
+	static const std::string empty;
+	if (id >= HEADER_COUNT || !_present[id]) {
+		return empty;
+	}
+	return _known[id];
 }
 
 const std::string& Response::getHeader(const std::string& key) const {
 	static const std::string empty;
-	std::map<std::string, std::string>::const_iterator it = _headers.find(key);
-	if (it != _headers.end()) {
-		return it->second;
+	HeaderId id = HttpHeaders::lookup(key.data(), key.size());
+	if (id != HEADER_UNKNOWN) {
+		return getHeader(id);
 	}
-	return empty;
+	size_t index = findExtra(key);
+	return index < _extra.size() ? _extra[index].second : empty;
+}
+
+bool Response::hasHeader(HeaderId id) const {
+	return id < HEADER_COUNT && _present[id];
 }
 
 bool Response::hasHeader(const std::string& key) const {
-	return _headers.find(key) != _headers.end();
+	HeaderId id = HttpHeaders::lookup(key.data(), key.size());
+	if (id != HEADER_UNKNOWN) {
+		return hasHeader(id);
+	}
+	return findExtra(key) < _extra.size();
 }
 
 const std::string& Response::getBody() const {
@@ -100,44 +285,67 @@ const std::string& Response::getBody() const {
 }
 
 size_t Response::getBodySize() const {
-	return _body.size();
+	if (_cached) {
+		return _cached->size;
+	}
+	return _bodyFile >= 0 ? _bodyFileSize : _body.size();
 }
 
-std::string Response::buildResponse() const {
-	std::ostringstream oss;
-	
-	// Status line
-	oss << "HTTP/1.1 " << _statusCode << " " << _statusMessage << "\r\n";
-	
-	// Headers
-	for (std::map<std::string, std::string>::const_iterator it = _headers.begin();
-		 it != _headers.end(); ++it) {
-		oss << it->first << ": " << it->second << "\r\n";
+void Response::serializeHead(std::string& out) const {
+	if (_statusLine) {
+		out.assign(_statusLine);
+	} else {
+		char code[5] = {
+			' ',
+			static_cast<char>('0' + _statusCode / 100 % 10),
+			static_cast<char>('0' + _statusCode / 10 % 10),
+			static_cast<char>('0' + _statusCode % 10),
+			' '
+		};
+		out.assign("HTTP/1.1", 8);
+		out.append(code, 5);
+		out += _statusMessage;
+		out.append("\r\n", 2);
 	}
 	
-	// Empty line
-	oss << "\r\n";
-	
-	// Body
-	oss << _body;
-	
-	return oss.str();
+	// Headers: los conocidos en el orden del enum, después el resto. Date
+	// sale del compartido al serializar, no de cuando se preparó la respuesta
+	for (int id = 0; id < HEADER_COUNT; ++id) {
+		if (!_present[id])
+			continue;
+		out += HttpHeaders::name(static_cast<HeaderId>(id));
+		out.append(": ", 2);
+		if (id == HEADER_DATE)
+			out.append(currentDate(), DATE_LEN);
+		else
+			out += _known[id];
+		out.append("\r\n", 2);
+	}
+	for (size_t i = 0; i < _extra.size(); ++i) {
+		out += _extra[i].first;
+		out.append(": ", 2);
+		out += _extra[i].second;
+		out.append("\r\n", 2);
+	}
+	if (_cached) {
+		out += _cached->headers;
+	}
+	out.append("\r\n", 2);
 }
 
 void Response::clear() {
 	_statusCode = 200;
-	_statusMessage = "OK";
-	_headers.clear();
+	_statusLine = findStatusLine(200);
+	std::fill(_present, _present + HEADER_COUNT, false);
+	_extra.clear();
 	_body.clear();
-	setHeader("Server", "webserv/1.0");
-	setHeader("Date", getDateHeader());
+	dropBodySources();
+	setHeader(HEADER_SERVER, "webserv/1.0");
+	_present[HEADER_DATE] = true;	// el valor lo pone serializeHead
 }
 
-std::string Response::getDateHeader() const {
-	char buffer[128];
-	time_t now = time(NULL);
-	struct tm* gmt = gmtime(&now);
-	strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", gmt);
-	return std::string(buffer);
+// Para reutilizar el objeto: vacía el body y suelta su memoria si es grande
+size_t Response::releaseBuffers(size_t maxCapacity) {
+	return Utils::trimCapacity(_body, maxCapacity);
 }
 
@@ -23,7 +23,8 @@
 Router::RoutingResult Router::route(
 	const std::vector<ServerConfig>& servers,
 	const Request& request,
-	int serverSocketFd
+	int serverSocketFd,
+	OpenFileCache* files
 ) {
 	RoutingResult result;
 	
@@ -34,22 +35,16 @@ Router::RoutingResult Router::route(
 	
 	result.location = findLocation(result.server, request.getPath());
 	
-	if (result.location) {
-		// Check if method is allowed
-		const std::vector<std::string>& allowed = result.location->allowedMethods;
-		bool methodAllowed = false;
-		for (size_t i = 0; i < allowed.size(); ++i) {
-			if (allowed[i] == request.getMethod()) {
-				methodAllowed = true;
-				break;
-			}
-		}
-		if (!methodAllowed && !allowed.empty()) {
-			return result; // Will return 405
-		}
+	if (!methodAllowed(result.location, request.getMethod())) {
+		return result; // Will return 405
 	}
 	
 	result.filePath = buildFilePath(result.server, result.location, request.getPath());
+	// Sólo la lectura de un directorio se sirve por su index: un POST o un
+	// DELETE sobre él no puede acabar en su index.html
+	if (files && (request.getMethod() == "GET" || request.getMethod() == "HEAD")) {
+		resolveIndex(result, *files);
+	}
 	result.isCGI = isCGIRequest(result.location, result.filePath);
 	if (result.isCGI) {
 		result.cgiExecutor = getCGIExecutor(result.location, result.filePath);
@@ -58,12 +53,37 @@ Router::RoutingResult Router::route(
 	return result;
 }
 
+size_t Router::bodyLimit(
+	const ServerConfig* server,
+	const LocationConfig* location
+) {
+	if (location && location->clientMaxBodySize > 0) {
+		return location->clientMaxBodySize;
+	}
+	return server ? server->clientMaxBodySize : 0;
+}
+
+bool Router::methodAllowed(
+	const LocationConfig* location,
+	const std::string& method
+) {
+	if (!location || location->allowedMethods.empty()) {
+		return true;
+	}
+	const std::vector<std::string>& allowed = location->allowedMethods;
+	if (std::find(allowed.begin(), allowed.end(), method) != allowed.end()) {
+		return true;
+	}
+	// HEAD es un GET sin body: donde se admite GET se admite HEAD
+	return method == "HEAD" && std::find(allowed.begin(), allowed.end(), "GET") != allowed.end();
+}
+
 const ServerConfig* Router::findServer(
 	const std::vector<ServerConfig>& servers,
 	const Request& request,
 	int serverSocketFd
 ) {
-	std::string hostHeader = request.getHeader("host");
+	std::string hostHeader = request.getHeader(HEADER_HOST);
 	std::string hostName;
 	
 	if (!hostHeader.empty()) {
@@ -142,6 +162,9 @@ const LocationConfig* Router::findLocation(
 	return bestMatch;
 }
 
+// requestPath ya viene normalizada (Request::parseUri): empieza por '/' y
+// no tiene "//", "." ni "..", así que basta con quitarle el prefijo de la
+// location y pegarla al root, sin salir de él
 std::string Router::buildFilePath(
 	const ServerConfig* server,
 	const LocationConfig* location,
@@ -149,39 +172,63 @@ std::string Router::buildFilePath(
 ) {
 	if (!server) return "";
 	
-	std::string root = server->root;
+	const std::string* root = &server->root;
 	if (location && !location->root.empty()) {
-		root = location->root;
+		root = &location->root;
 	}
-	
-	if (root.empty()) {
-		root = "./www";
+	static const std::string defaultRoot = "./www";
+	if (root->empty()) {
+		root = &defaultRoot;
 	}
 	
-	std::string path = requestPath;
-	if (location && !location->path.empty()) {
-		// Remove location path prefix
-		if (path.find(location->path) == 0) {
-			path = path.substr(location->path.length());
-		}
+	size_t skip = 0;
+	if (location && !location->path.empty()
+		&& requestPath.compare(0, location->path.size(), location->path) == 0) {
+		skip = location->path.size();
+	}
+	if (skip < requestPath.size() && requestPath[skip] == '/') {
+		++skip;
 	}
 	
-	if (path.empty() || path == "/") {
-		path = "/";
-		if (!server->index.empty()) {
-			return root + path + server->index;
-		}
-		return root + "/";
+	size_t rootLen = root->size();
+	if ((*root)[rootLen - 1] == '/') {
+		--rootLen;
 	}
 	
-	// Remove leading slash if root doesn't end with one
-	if (path[0] == '/' && root[root.length() - 1] == '/') {
-		path = path.substr(1);
-	} else if (path[0] != '/' && root[root.length() - 1] != '/') {
-		path = "/" + path;
+	std::string filePath;
+	filePath.reserve(rootLen + 1 + (requestPath.size() - skip) + server->index.size());
+	filePath.append(*root, 0, rootLen);
+	filePath += '/';
+	filePath.append(requestPath, skip, std::string::npos);
+	if (skip == requestPath.size()) {
+		// La raíz de la location: su index, si lo hay
+		filePath += server->index;
+	}
+	return filePath;
+}
+
+// Un directorio sin autoindex se sirve por su index (el del server, o
+// index.html), si existe. Con autoindex manda el listado
+void Router::resolveIndex(
+	RoutingResult& result,
+	OpenFileCache& files
+) {
+	if (result.location && result.location->autoindex) {
+		return;
+	}
+	const FileInfo& dir = files.lookup(result.filePath, false);
+	if (!dir.exists() || !dir.isDirectory) {
+		return;
 	}
 	
-	return root + path;
+	std::string indexPath = result.filePath;
+	if (indexPath[indexPath.size() - 1] != '/') {
+		indexPath += '/';
+	}
+	indexPath += result.server->index.empty() ? "index.html" : result.server->index;
+	if (files.lookup(indexPath, false).isFile()) {
+		result.filePath.swap(indexPath);
+	}
 }
 
 bool Router::isCGIRequest(
@@ -47,9 +47,10 @@ int Server::normalizePort(const std::string& ipPort) {
 	return port;
 }
 
-Server::Server(const ServerConfig& config) : _config(config) {
+Server::Server(const ServerConfig& config, bool reusePort) : _config(config) {
 	for (size_t i = 0; i < _config.listen.size(); i++) {
 		const std::string& ipPort = _config.listen[i];
+		const ListenOptions& options = _config.listenOptions[i];
 		int port = normalizePort(ipPort);
 		
 		if (port == -1) {
@@ -61,7 +62,7 @@ Server::Server(const ServerConfig& config) : _config(config) {
 		// Verificar si el puerto ya está en uso
 		if (_globalSocketMap.find(port) == _globalSocketMap.end()) {
 			// Puerto no usado, crear socket
-			int sock = createSocket(ipPort);
+			int sock = createSocket(ipPort, reusePort, options.backlog);
 			if (sock == -1) {
 				// Error al crear socket - verificar si es porque el puerto ya está en uso
 				if (errno == EADDRINUSE) {
@@ -82,6 +83,7 @@ Server::Server(const ServerConfig& config) : _config(config) {
 		std::map<int, int>::iterator it = _globalSocketMap.find(port);
 		if (it != _globalSocketMap.end() && it->second >= 0) {
 			_listenSockets.push_back(it->second);
+			_acceptBatches.push_back(options.acceptBatch);
 		} else {
 			std::ostringstream oss;
 			oss << "Error: Invalid socket for port " << port;
@@ -94,7 +96,19 @@ Server::~Server() {
 	// ⚠️ No cerramos los sockets aquí, porque son compartidos por múltiples servidores.
 }
 
-int Server::createSocket(const std::string& ipPort) {
+// Cierra los sockets de escucha compartidos (el master los abre sólo para
+// validar la configuración antes de lanzar los workers)
+void Server::closeAllSockets() {
+	for (std::map<int, int>::iterator it = _globalSocketMap.begin();
+		 it != _globalSocketMap.end(); ++it) {
+		if (it->second >= 0)
+			close(it->second);
+	}
+	_globalSocketMap.clear();
+	_portToIpPort.clear();
+}
+
+int Server::createSocket(const std::string& ipPort, bool reusePort, int backlog) {
 	std::string ip = "0.0.0.0";
 	int port = 0;
 
@@ -122,6 +136,15 @@ int Server::createSocket(const std::string& ipPort) {
 	if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
 		perror("setsockopt");
 
+#ifdef SO_REUSEPORT
+	// Con varios workers cada uno tiene su propia copia del socket y el
+	// kernel reparte las conexiones entrantes entre ellas
+	if (reusePort && setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+		perror("setsockopt(SO_REUSEPORT)");
+#else
+	(void)reusePort;
+#endif
+
 	// 🔹 Hacer socket no bloqueante
 	int flags = fcntl(sockfd, F_GETFL, 0);
 	fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
@@ -143,7 +166,8 @@ int Server::createSocket(const std::string& ipPort) {
 		return -1;
 	}
 
-	if (listen(sockfd, 128) < 0) {
+	// El kernel lo recorta a net.core.somaxconn
+	if (listen(sockfd, backlog) < 0) {
 		perror("listen");
 		close(sockfd);
 		return -1;
@@ -155,3 +179,7 @@ int Server::createSocket(const std::string& ipPort) {
 const std::vector<int>& Server::getSockets() const {
 	return _listenSockets;
 }
+
+const std::vector<size_t>& Server::getAcceptBatches() const {
+	return _acceptBatches;
+}
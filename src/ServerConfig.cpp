@@ -12,6 +12,8 @@
 
 #include "ServerConfig.hpp"
 
+ListenOptions::ListenOptions() : backlog(511), acceptBatch(64) {}
+
 ServerConfig::ServerConfig()
     : root(""), index(""), clientMaxBodySize(0) {}
 	
@@ -22,8 +24,9 @@ Inicializa root e index como cadenas vacías ("")
 Inicializa clientMaxBodySize en 0
 Estos valores serán actualizados posteriormente con los datos del archivo de configuración. */
 
-void ServerConfig::addListen(const std::string& ipPort) {
+void ServerConfig::addListen(const std::string& ipPort, const ListenOptions& options) {
     listen.push_back(ipPort);
+    listenOptions.push_back(options);
 }
 /* 📡 Método para añadir una directiva listen (ej: "127.0.0.1:8080") al vector listen.
 Esto permite múltiples listen en un mismo bloque server. */
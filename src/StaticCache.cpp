@@ -0,0 +1,152 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   StaticCache.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 01:04:18 by luis              #+#    #+#             */
+/*   Updated: 2026/10/17 01:04:18 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "StaticCache.hpp"
+#include "HttpHeaders.hpp"
+#include "Utils.hpp"
+#include <cstdio>
+
+StaticCache::StaticCache()
+	: _maxBytes(0), _maxFileSize(0), _maxEntries(0), _bytes(0), _hits(0), _misses(0),
+	  _evictions(0) {
+}
+
+StaticCache::~StaticCache() {
+	clear();
+}
+
+void StaticCache::configure(size_t maxBytes, size_t maxFileSize, size_t maxEntries) {
+	clear();
+	_maxBytes = maxBytes;
+	_maxFileSize = maxFileSize < maxBytes ? maxFileSize : maxBytes;
+	_maxEntries = maxEntries;
+}
+
+bool StaticCache::accepts(size_t size) const {
+	return _maxBytes > 0 && _maxEntries > 0 && size <= _maxFileSize;
+}
+
+CachedFile* StaticCache::find(const std::string& path, const FileInfo& file) {
+	EntryIndex::iterator it = _index.find(path);
+	if (it == _index.end()) {
+		_misses++;
+		return NULL;
+	}
+	CachedFile* cached = it->second->file;
+	if (cached->inode != file.inode || cached->mtime != file.mtime || cached->size != file.size) {
+		// El fichero ha cambiado desde que se guardó
+		erase(it);
+		_misses++;
+		return NULL;
+	}
+	_entries.splice(_entries.begin(), _entries, it->second);
+	_hits++;
+	return cached;
+}
+
+CachedFile* StaticCache::insert(const std::string& path, const FileInfo& file, std::string& content,
+								const char* contentType) {
+	if (!accepts(file.size) || content.size() != file.size) {
+		return NULL;
+	}
+	invalidate(path);
+	
+	CachedFile* cached = new CachedFile();
+	cached->content.swap(content);
+	cached->size = file.size;
+	cached->mtime = file.mtime;
+	cached->inode = file.inode;
+	
+	char length[24];
+	snprintf(length, sizeof(length), "%lu", static_cast<unsigned long>(file.size));
+	std::string& headers = cached->headers;
+	headers.reserve(160);
+	headers.append(HttpHeaders::name(HEADER_CONTENT_TYPE)).append(": ").append(contentType).append("\r\n");
+	headers.append(HttpHeaders::name(HEADER_CONTENT_LENGTH)).append(": ").append(length).append("\r\n");
+	headers.append(HttpHeaders::name(HEADER_LAST_MODIFIED)).append(": ")
+		   .append(Utils::httpDate(file.mtime)).append("\r\n");
+	headers.append(HttpHeaders::name(HEADER_ETAG)).append(": ")
+		   .append(Utils::entityTag(file.inode, file.mtime, file.size)).append("\r\n");
+	
+	// Hueco para la nueva: fuera las usadas hace más tiempo
+	size_t needed = footprint(cached);
+	while (!_entries.empty() && (_bytes + needed > _maxBytes || _entries.size() >= _maxEntries)) {
+		erase(_index.find(_entries.back().path));
+		_evictions++;
+	}
+	
+	_entries.push_front(Entry());
+	_entries.front().path = path;
+	_entries.front().file = cached;
+	_index[path] = _entries.begin();
+	_bytes += needed;
+	return cached;
+}
+
+void StaticCache::invalidate(const std::string& path) {
+	EntryIndex::iterator it = _index.find(path);
+	if (it != _index.end()) {
+		erase(it);
+	}
+}
+
+void StaticCache::clear() {
+	for (EntryList::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		release(it->file);
+	}
+	_entries.clear();
+	_index.clear();
+	_bytes = 0;
+}
+
+// La entrada sale de la caché; el contenido sigue vivo mientras lo esté
+// enviando alguna respuesta
+void StaticCache::erase(EntryIndex::iterator it) {
+	_bytes -= footprint(it->second->file);
+	release(it->second->file);
+	_entries.erase(it->second);
+	_index.erase(it);
+}
+
+size_t StaticCache::footprint(const CachedFile* file) {
+	return file->content.size() + file->headers.size();
+}
+
+void StaticCache::retain(CachedFile* file) {
+	file->refs++;
+}
+
+void StaticCache::release(CachedFile* file) {
+	if (--file->refs == 0) {
+		delete file;
+	}
+}
+
+size_t StaticCache::getHits() const {
+	return _hits;
+}
+
+size_t StaticCache::getMisses() const {
+	return _misses;
+}
+
+size_t StaticCache::getEvictions() const {
+	return _evictions;
+}
+
+size_t StaticCache::getBytes() const {
+	return _bytes;
+}
+
+size_t StaticCache::getSize() const {
+	return _entries.size();
+}
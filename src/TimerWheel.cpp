@@ -0,0 +1,135 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 16:12:44 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 16:12:44 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "TimerWheel.hpp"
+#include <ctime>
+
+TimerWheel::TimerWheel() : _count(0) {
+	for (int level = 0; level < LEVELS; ++level) {
+		for (int slot = 0; slot < SLOTS; ++slot) {
+			_slots[level][slot].prev = &_slots[level][slot];
+			_slots[level][slot].next = &_slots[level][slot];
+		}
+	}
+	_current = nowMs() / TICK_MS;
+}
+
+uint64_t TimerWheel::nowMs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void TimerWheel::schedule(TimerNode& node, uint64_t deadlineMs) {
+	cancel(node);
+	// Redondear hacia arriba: nunca vencer antes de tiempo
+	node.expires = (deadlineMs + TICK_MS - 1) / TICK_MS;
+	link(node);
+	_count++;
+}
+
+void TimerWheel::cancel(TimerNode& node) {
+	if (!node.isPending())
+		return;
+	unlink(node);
+	_count--;
+}
+
+void TimerWheel::unlink(TimerNode& node) {
+	node.prev->next = node.next;
+	node.next->prev = node.prev;
+	node.prev = NULL;
+	node.next = NULL;
+}
+
+// Elige nivel y ranura según lo lejos que quede el vencimiento
+void TimerWheel::link(TimerNode& node) {
+	if (node.expires < _current)
+		node.expires = _current;
+
+	uint64_t delta = node.expires - _current;
+	uint64_t maxDelta = (static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS)) - 1;
+	if (delta > maxDelta) {
+		node.expires = _current + maxDelta;
+		delta = maxDelta;
+	}
+
+	int level = 0;
+	while (level < LEVELS - 1 && delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1))))
+		level++;
+
+	TimerNode& head = _slots[level][(node.expires >> (SLOT_BITS * level)) & (SLOTS - 1)];
+	node.prev = head.prev;
+	node.next = &head;
+	head.prev->next = &node;
+	head.prev = &node;
+}
+
+// Redistribuye la ranura actual de un nivel en los niveles inferiores
+void TimerWheel::cascade(int level) {
+	size_t index = (_current >> (SLOT_BITS * level)) & (SLOTS - 1);
+	if (index == 0 && level + 1 < LEVELS)
+		cascade(level + 1);
+
+	TimerNode& head = _slots[level][index];
+	while (head.next != &head) {
+		TimerNode* node = head.next;
+		unlink(*node);
+		link(*node);
+	}
+}
+
+void TimerWheel::advance(uint64_t nowMs, std::vector<TimerNode*>& expired) {
+	uint64_t nowTick = nowMs / TICK_MS;
+
+	if (_count == 0) {
+		// Nada programado: saltar directamente sin recorrer ticks
+		if (_current <= nowTick)
+			_current = nowTick + 1;
+		return;
+	}
+
+	while (_current <= nowTick) {
+		size_t index = _current & (SLOTS - 1);
+		if (index == 0)
+			cascade(1);
+
+		TimerNode& head = _slots[0][index];
+		while (head.next != &head) {
+			TimerNode* node = head.next;
+			unlink(*node);
+			_count--;
+			expired.push_back(node);
+		}
+		_current++;
+	}
+}
+
+int TimerWheel::nextTimeout(uint64_t nowMs) const {
+	if (_count == 0)
+		return -1;
+
+	// Primer tick con algo en el nivel 0, o la próxima bajada de nivel
+	uint64_t tick = _current;
+	for (int k = 0; k < SLOTS; ++k, ++tick) {
+		if ((tick & (SLOTS - 1)) == 0)
+			break;
+		const TimerNode& head = _slots[0][tick & (SLOTS - 1)];
+		if (head.next != &head)
+			break;
+	}
+
+	uint64_t dueMs = tick * TICK_MS;
+	if (dueMs <= nowMs)
+		return 0;
+	return static_cast<int>(dueMs - nowMs);
+}
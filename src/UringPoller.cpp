@@ -0,0 +1,335 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   UringPoller.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: luis <luis@student.42.fr>                  +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/16 11:20:48 by luis              #+#    #+#             */
+/*   Updated: 2026/10/16 11:20:48 by luis             ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifdef __linux__
+
+#include "UringPoller.hpp"
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/time_types.h>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+
+// user_data de las operaciones cuyo resultado no interesa (bajas, timeout)
+static const uint64_t TAG_INTERNAL = ~static_cast<uint64_t>(0);
+
+static const unsigned RING_ENTRIES = 4096;
+
+static uint64_t makeTag(int fd, uint32_t generation) {
+	return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+UringPoller::UringPoller()
+	: _ringFd(-1), _features(0), _sqRing(MAP_FAILED), _sqRingSize(0), _sqHead(NULL),
+	  _sqTail(NULL), _sqMask(0), _sqEntries(0), _sqArray(NULL),
+	  _sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), _pending(0), _cqRing(MAP_FAILED),
+	  _cqRingSize(0), _cqHead(NULL), _cqTail(NULL), _cqMask(0), _cqes(NULL) {
+	if (!setup(RING_ENTRIES))
+		teardown();
+}
+
+UringPoller::~UringPoller() {
+	teardown();
+}
+
+bool UringPoller::isValid() const {
+	return _ringFd >= 0;
+}
+
+// Crea el anillo y mapea SQ, CQ y el array de SQEs. El fd que devuelve
+// io_uring_setup ya es close-on-exec.
+bool UringPoller::setup(unsigned entries) {
+	io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	_ringFd = syscall(__NR_io_uring_setup, entries, &params);
+	if (_ringFd < 0)
+		return false;
+	_features = params.features;
+
+	_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (_features & IORING_FEAT_SINGLE_MMAP) {
+		if (_cqRingSize > _sqRingSize)
+			_sqRingSize = _cqRingSize;
+		_cqRingSize = _sqRingSize;
+	}
+
+	_sqRing = mmap(NULL, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				   _ringFd, IORING_OFF_SQ_RING);
+	if (_sqRing == MAP_FAILED)
+		return false;
+	if (_features & IORING_FEAT_SINGLE_MMAP) {
+		_cqRing = _sqRing;
+	} else {
+		_cqRing = mmap(NULL, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+					   _ringFd, IORING_OFF_CQ_RING);
+		if (_cqRing == MAP_FAILED)
+			return false;
+	}
+	_sqes = static_cast<io_uring_sqe*>(mmap(NULL, params.sq_entries * sizeof(io_uring_sqe),
+											PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+											_ringFd, IORING_OFF_SQES));
+	if (_sqes == MAP_FAILED)
+		return false;
+
+	char* sq = static_cast<char*>(_sqRing);
+	_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	_sqEntries = params.sq_entries;
+	_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+	char* cq = static_cast<char*>(_cqRing);
+	_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	return true;
+}
+
+void UringPoller::teardown() {
+	if (_sqes != MAP_FAILED)
+		munmap(_sqes, _sqEntries * sizeof(io_uring_sqe));
+	if (_cqRing != MAP_FAILED && _cqRing != _sqRing)
+		munmap(_cqRing, _cqRingSize);
+	if (_sqRing != MAP_FAILED)
+		munmap(_sqRing, _sqRingSize);
+	_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	_sqRing = _cqRing = MAP_FAILED;
+	if (_ringFd >= 0)
+		close(_ringFd);
+	_ringFd = -1;
+}
+
+int UringPoller::enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+					   void* arg, size_t argSize) {
+	int ret = syscall(__NR_io_uring_enter, _ringFd, toSubmit, minComplete, flags, arg, argSize);
+	if (ret > 0)
+		_pending -= static_cast<unsigned>(ret) < _pending ? ret : _pending;
+	return ret;
+}
+
+// Siguiente SQE libre (ya puesto a cero). Si el anillo está lleno se envía
+// lo acumulado antes de seguir.
+io_uring_sqe* UringPoller::nextSqe() {
+	unsigned tail = *_sqTail;
+	if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries) {
+		enter(_pending, 0, 0, NULL, 0);
+		if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries)
+			return NULL;
+	}
+	unsigned index = tail & _sqMask;
+	_sqArray[index] = index;
+	io_uring_sqe* sqe = &_sqes[index];
+	std::memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+// Publica el SQE que devolvió nextSqe(): el kernel lo verá en el próximo enter
+static void publish(unsigned* tail, unsigned& pending) {
+	__atomic_store_n(tail, *tail + 1, __ATOMIC_RELEASE);
+	pending++;
+}
+
+UringPoller::Watch& UringPoller::watchFor(int fd) {
+	if (static_cast<size_t>(fd) >= _watches.size())
+		_watches.resize(fd + 1 > 64 ? fd * 2 : 64);
+	return _watches[fd];
+}
+
+void UringPoller::arm(int fd) {
+	Watch& watch = _watches[fd];
+	io_uring_sqe* sqe = nextSqe();
+	if (!sqe) {
+		// SQ llena aun después de enviar: se reintenta en el próximo wait()
+		_rearm.push_back(fd);
+		return;
+	}
+
+	unsigned mask = 0;
+	if (watch.events & EVENT_READ)
+		mask |= POLLIN;
+	if (watch.events & EVENT_WRITE)
+		mask |= POLLOUT;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = mask;
+	sqe->user_data = makeTag(fd, watch.generation);
+	publish(_sqTail, _pending);
+	watch.armed = true;
+}
+
+// Cancela la poll en vuelo; su completion llegará con la generación vieja
+// y se descartará
+void UringPoller::disarm(int fd) {
+	Watch& watch = _watches[fd];
+	if (!watch.armed)
+		return;
+	cancel(makeTag(fd, watch.generation));
+	watch.armed = false;
+	watch.generation++;
+}
+
+// POLL_REMOVE de la poll con ese user_data. Si no cabe se guarda: una poll
+// sin cancelar mantiene una referencia al socket hasta que salte
+void UringPoller::cancel(uint64_t tag) {
+	io_uring_sqe* sqe = nextSqe();
+	if (!sqe) {
+		_cancels.push_back(tag);
+		return;
+	}
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = tag;
+	sqe->user_data = TAG_INTERNAL;
+	publish(_sqTail, _pending);
+}
+
+bool UringPoller::add(int fd, int events) {
+	if (fd < 0)
+		return false;
+	Watch& watch = watchFor(fd);
+	disarm(fd);
+	watch.generation++;
+	watch.registered = true;
+	watch.events = events;
+	if (events)
+		arm(fd);
+	return true;
+}
+
+bool UringPoller::modify(int fd, int events) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || !_watches[fd].registered)
+		return false;
+	disarm(fd);
+	_watches[fd].events = events;
+	if (events)
+		arm(fd);
+	return true;
+}
+
+void UringPoller::remove(int fd) {
+	// La baja sale en el próximo enter; hasta entonces el kernel mantiene
+	// una referencia al socket aunque ya se haya hecho close()
+	if (fd < 0 || static_cast<size_t>(fd) >= _watches.size() || !_watches[fd].registered)
+		return;
+	disarm(fd);
+	_watches[fd].registered = false;
+	_watches[fd].events = 0;
+}
+
+int UringPoller::wait(std::vector<Event>& ready, int timeoutMs) {
+	ready.clear();
+
+	// Bajas que no cupieron en la SQ la última vez
+	_retry.swap(_cancels);
+	for (size_t i = 0; i < _retry.size(); ++i)
+		cancel(_retry[i]);
+	_retry.clear();
+
+	// POLL_ADD es de un disparo: volver a armar lo que saltó la última vez
+	// (si sigue listo, se completa en cuanto se envía) y lo que no se pudo
+	// armar. Lo que vuelva a fallar queda en _rearm para la siguiente
+	_rearming.swap(_rearm);
+	for (size_t i = 0; i < _rearming.size(); ++i) {
+		int fd = _rearming[i];
+		Watch& watch = _watches[fd];
+		if (watch.registered && !watch.armed && watch.events)
+			arm(fd);
+	}
+	_rearming.clear();
+
+	// Con algo aún sin armar no se bloquea: se reintenta en la siguiente vuelta
+	unsigned pendingCqes = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE) - *_cqHead;
+	bool retryPending = !_rearm.empty() || !_cancels.empty();
+	unsigned minComplete = (timeoutMs == 0 || pendingCqes > 0 || retryPending) ? 0 : 1;
+	unsigned flags = IORING_ENTER_GETEVENTS;
+	__kernel_timespec ts;
+	io_uring_getevents_arg arg;
+	void* argPtr = NULL;
+	size_t argSize = 0;
+
+	if (minComplete && timeoutMs > 0) {
+		ts.tv_sec = timeoutMs / 1000;
+		ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+		if (_features & IORING_FEAT_EXT_ARG) {
+			std::memset(&arg, 0, sizeof(arg));
+			arg.sigmask_sz = _NSIG / 8;
+			arg.ts = reinterpret_cast<uint64_t>(&ts);
+			argPtr = &arg;
+			argSize = sizeof(arg);
+			flags |= IORING_ENTER_EXT_ARG;
+		} else if (io_uring_sqe* sqe = nextSqe()) {
+			// Kernels < 5.11: un TIMEOUT que vence solo o con la primera completion
+			sqe->opcode = IORING_OP_TIMEOUT;
+			sqe->fd = -1;
+			sqe->addr = reinterpret_cast<uint64_t>(&ts);
+			sqe->len = 1;
+			sqe->off = 1;
+			sqe->user_data = TAG_INTERNAL;
+			publish(_sqTail, _pending);
+		} else {
+			// Sin SQE para el TIMEOUT la espera no tendría límite
+			minComplete = 0;
+		}
+	}
+
+	if (enter(_pending, minComplete, flags, argPtr, argSize) < 0
+		&& errno != EINTR && errno != ETIME && errno != EBUSY)
+		return -1;
+
+	unsigned head = *_cqHead;
+	unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+	for (; head != tail; ++head) {
+		const io_uring_cqe& cqe = _cqes[head & _cqMask];
+		if (cqe.user_data == TAG_INTERNAL)
+			continue;
+
+		int fd = static_cast<int>(cqe.user_data & 0xffffffffu);
+		uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+		if (static_cast<size_t>(fd) >= _watches.size())
+			continue;
+		Watch& watch = _watches[fd];
+		if (!watch.registered || watch.generation != generation)
+			continue;	// de un registro ya dado de baja o modificado
+
+		watch.armed = false;
+		_rearm.push_back(fd);
+
+		Event ev;
+		ev.fd = fd;
+		ev.events = 0;
+		if (cqe.res < 0) {
+			ev.events = EVENT_ERROR;
+		} else {
+			if (cqe.res & POLLIN)
+				ev.events |= EVENT_READ;
+			if (cqe.res & POLLOUT)
+				ev.events |= EVENT_WRITE;
+			if (cqe.res & (POLLERR | POLLHUP | POLLNVAL))
+				ev.events |= EVENT_ERROR;
+		}
+		ready.push_back(ev);
+	}
+	__atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+	return static_cast<int>(ready.size());
+}
+
+const char* UringPoller::getName() const {
+	return "io_uring";
+}
+
+#endif
@@ -18,19 +18,71 @@
 #include <ctime>
 #include <cstring>
 #include <cctype>
+#include <strings.h>
+
+namespace {
+
+// Valor de cada dígito hexadecimal; -1 para el resto de bytes
+const signed char g_hex[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x00
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x10
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x20
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,	// 0x30
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x40
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x50
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x60
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x70
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x80
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0x90
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xa0
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xb0
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xc0
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xd0
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xe0
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,	// 0xf0
+};
+
+// Valor de "%XX" a partir del '%'; -1 si no le siguen dos dígitos hex
+int decodeEscape(const char* p) {
+	int high = g_hex[static_cast<unsigned char>(p[1])];
+	int low = g_hex[static_cast<unsigned char>(p[2])];
+	if (high < 0 || low < 0)
+		return -1;
+	return (high << 4) | low;
+}
+
+// Cierra el segmento que empieza en segStart: "." desaparece, ".." se lleva
+// también el anterior, y uno normal recibe su '/' (salvo el último). Un
+// segmento vacío no añade nada, así que "//" queda en "/". Devuelve false
+// si ".." subiría por encima de la raíz
+bool closeSegment(std::string& out, size_t& segStart, bool last) {
+	size_t segLen = out.size() - segStart;
+	if (segLen == 1 && out[segStart] == '.') {
+		out.resize(segStart);
+	} else if (segLen == 2 && out[segStart] == '.' && out[segStart + 1] == '.') {
+		if (segStart == 1)
+			return false;
+		segStart = out.rfind('/', segStart - 2) + 1;
+		out.resize(segStart);
+	} else if (segLen > 0 && !last) {
+		out += '/';
+		segStart = out.size();
+	}
+	return true;
+}
+
+}
 
 std::string Utils::urlDecode(const std::string& str) {
 	std::string result;
+	result.reserve(str.length());
 	for (size_t i = 0; i < str.length(); ++i) {
-		if (str[i] == '%' && i + 2 < str.length()) {
-			int value;
-			std::istringstream iss(str.substr(i + 1, 2));
-			if (iss >> std::hex >> value) {
-				result += static_cast<char>(value);
-				i += 2;
-			} else {
-				result += str[i];
-			}
+		int value = -1;
+		if (str[i] == '%' && i + 2 < str.length())
+			value = decodeEscape(str.data() + i);
+		if (value >= 0) {
+			result += static_cast<char>(value);
+			i += 2;
 		} else if (str[i] == '+') {
 			result += ' ';
 		} else {
@@ -40,28 +92,66 @@ std::string Utils::urlDecode(const std::string& str) {
 	return result;
 }
 
-std::string Utils::getMimeType(const std::string& filePath) {
+// Decodifica los %XX de la ruta de una petición y la normaliza en la misma
+// pasada, escribiendo en 'out' (que conserva su capacidad de una petición a
+// otra). El resultado empieza por '/' y no tiene "//", "." ni "..", así que
+// se puede pegar a un root o usar como clave. Falla si la ruta no empieza
+// por '/', con un escape mal formado o %00, o si sale de la raíz
+bool Utils::normalizePath(const char* data, size_t len, std::string& out) {
+	out.clear();
+	if (len == 0 || data[0] != '/')
+		return false;
+	out += '/';
+	
+	size_t segStart = 1;
+	for (size_t i = 1; i < len; ++i) {
+		// Lo que no es '%' ni '/' se copia de una vez
+		size_t run = i;
+		while (run < len && data[run] != '%' && data[run] != '/')
+			++run;
+		if (run > i) {
+			out.append(data + i, run - i);
+			i = run - 1;
+			continue;
+		}
+		
+		int c = static_cast<unsigned char>(data[i]);
+		if (c == '%') {
+			// Decodificado antes de mirar segmentos: %2e%2e también es ".."
+			c = (i + 2 < len) ? decodeEscape(data + i) : -1;
+			if (c <= 0)
+				return false;
+			i += 2;
+		}
+		if (c == '/') {
+			if (!closeSegment(out, segStart, false))
+				return false;
+		} else {
+			out += static_cast<char>(c);
+		}
+	}
+	return closeSegment(out, segStart, true);
+}
+
+// Literal estático: el Response lo copia a su hueco sin crear strings
+const char* Utils::getMimeType(const std::string& filePath) {
 	size_t dot = filePath.find_last_of('.');
 	if (dot == std::string::npos) {
 		return "application/octet-stream";
 	}
 	
-	std::string ext = filePath.substr(dot);
-	for (size_t i = 0; i < ext.length(); ++i) {
-		ext[i] = std::tolower(ext[i]);
-	}
-	
-	if (ext == ".html" || ext == ".htm") return "text/html; charset=utf-8";
-	if (ext == ".css") return "text/css; charset=utf-8";
-	if (ext == ".js") return "application/javascript; charset=utf-8";
-	if (ext == ".json") return "application/json; charset=utf-8";
-	if (ext == ".png") return "image/png";
-	if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
-	if (ext == ".gif") return "image/gif";
-	if (ext == ".svg") return "image/svg+xml";
-	if (ext == ".txt") return "text/plain; charset=utf-8";
-	if (ext == ".pdf") return "application/pdf";
-	if (ext == ".xml") return "application/xml; charset=utf-8";
+	const char* ext = filePath.c_str() + dot;
+	if (strcasecmp(ext, ".html") == 0 || strcasecmp(ext, ".htm") == 0) return "text/html; charset=utf-8";
+	if (strcasecmp(ext, ".css") == 0) return "text/css; charset=utf-8";
+	if (strcasecmp(ext, ".js") == 0) return "application/javascript; charset=utf-8";
+	if (strcasecmp(ext, ".json") == 0) return "application/json; charset=utf-8";
+	if (strcasecmp(ext, ".png") == 0) return "image/png";
+	if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) return "image/jpeg";
+	if (strcasecmp(ext, ".gif") == 0) return "image/gif";
+	if (strcasecmp(ext, ".svg") == 0) return "image/svg+xml";
+	if (strcasecmp(ext, ".txt") == 0) return "text/plain; charset=utf-8";
+	if (strcasecmp(ext, ".pdf") == 0) return "application/pdf";
+	if (strcasecmp(ext, ".xml") == 0) return "application/xml; charset=utf-8";
 	
 	return "application/octet-stream";
 }
@@ -182,3 +272,46 @@ size_t Utils::parseSize(const std::string& sizeStr) {
 	return value;
 }
 
+// Vacía str y libera su memoria si pasa de maxCapacity; devuelve la
+// capacidad que conserva
+size_t Utils::trimCapacity(std::string& str, size_t maxCapacity) {
+	str.clear();
+	if (str.capacity() > maxCapacity) {
+		std::string().swap(str);
+	}
+	return str.capacity();
+}
+
+std::string Utils::httpDate(time_t when) {
+	struct tm gmt;
+	gmtime_r(&when, &gmt);
+	char buffer[32];
+	size_t len = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+	return std::string(buffer, len);
+}
+
+// IMF-fixdate y, como pide el RFC, los obsoletos RFC 850 y asctime()
+bool Utils::parseHttpDate(const std::string& value, time_t& when) {
+	static const char* const FORMATS[] = {
+		"%a, %d %b %Y %H:%M:%S GMT",
+		"%A, %d-%b-%y %H:%M:%S GMT",
+		"%a %b %e %H:%M:%S %Y"
+	};
+	for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); ++i) {
+		struct tm gmt;
+		std::memset(&gmt, 0, sizeof(gmt));
+		const char* end = strptime(value.c_str(), FORMATS[i], &gmt);
+		if (end && *end == '\0') {
+			when = timegm(&gmt);
+			return when != static_cast<time_t>(-1);
+		}
+	}
+	return false;
+}
+
+std::string Utils::entityTag(ino_t inode, time_t mtime, size_t size) {
+	char buffer[64];
+	int len = snprintf(buffer, sizeof(buffer), "\"%lx-%lx-%lx\"", static_cast<unsigned long>(inode),
+					   static_cast<unsigned long>(mtime), static_cast<unsigned long>(size));
+	return std::string(buffer, static_cast<size_t>(len));
+}
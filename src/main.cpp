@@ -11,8 +11,7 @@
 /* ************************************************************************** */
 
 #include "ConfigParser.hpp"
-#include "Server.hpp"
-#include "Listener.hpp"
+#include "Master.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <string>
@@ -33,20 +32,15 @@ int main(int argc, char** argv) {
 			return 1;
 		}
 
-		// Create Server instances
-		std::vector<Server*> servers;
-		for (size_t i = 0; i < serverConfigs.size(); ++i) {
-			servers.push_back(new Server(serverConfigs[i]));
+		const GlobalConfig& global = parser.getGlobal();
+		if (global.resolveWorkerProcesses() > 1) {
+			// Modo multiproceso: el master supervisa y los workers atienden
+			Master master(serverConfigs, global);
+			return master.run();
 		}
 
-		// Create Listener and run
-		Listener listener(servers, serverConfigs);
-		listener.run();
-
-		// Cleanup (unreachable in normal operation)
-		for (size_t i = 0; i < servers.size(); ++i) {
-			delete servers[i];
-		}
+		// Un solo proceso: este mismo hace de worker
+		return Master::runWorker(serverConfigs, global, false);
 	} catch (const std::exception& e) {
 		std::cerr << "Error: " << e.what() << '\n';
 		return 1;